@@ -0,0 +1,368 @@
+#pragma once
+
+/*
+ * Prymitywy synchronizacji dla filozofów.
+ *
+ * Zamienniki std::mutex dla pałeczek (polityki blokady).
+ * Każda klasa ma ten sam interfejs co mutex: lock(), try_lock(), unlock(),
+ * więc strategie filozofów są szablonami i działają z każdą z nich.
+ *
+ *  - std::mutex        - zwykły mutex z biblioteki standardowej (punkt odniesienia),
+ *  - BlokadaBiletowa   - "bilety" jak w kolejce w urzędzie, ściśle FIFO, czeka aktywnie,
+ *  - BlokadaMCS        - kolejka MCS, każdy czekający kręci się na własnej zmiennej,
+ *  - BlokadaFutex      - najpierw krótko kręci się w miejscu, potem zasypia w jądrze (futex).
+ *
+ * Blokady aktywne (biletowa, MCS) po kilkuset obrotach oddają procesor (yield),
+ * bo przy większej liczbie filozofów niż rdzeni właściciel pałeczki mógłby
+ * w ogóle nie dostać czasu procesora, żeby ją oddać.
+ *
+ * Do przekazywania wiadomości (strategia Chandy-Misra): Dzwonek (usypianie do czasu
+ * nadejścia wiadomości) i KolejkaSPSC (skrzynka bez blokad).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <ctime>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// Podpowiedź dla procesora, że kręcimy się w pętli (PAUSE na x86, YIELD na ARM).
+inline void pauzaProcesora() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex wymaga atomic<int> bez dodatkowych pól");
+
+/*
+ * Uśpienie w jądrze, dopóki `slowo` ma wartość `oczekiwana` (futex), najdłużej `limitNs`
+ * (ujemny = bez limitu). Może wrócić wcześniej bez powodu - wołający zawsze sprawdza warunek.
+ * Poza Linuksem tylko oddaje procesor.
+ */
+inline void futexCzekaj(std::atomic<int>& slowo, int oczekiwana, long long limitNs) {
+#if defined(__linux__)
+    timespec limit{};
+    timespec* wskLimitu = nullptr;
+    if (limitNs >= 0) {
+        limit.tv_sec = limitNs / 1000000000LL;
+        limit.tv_nsec = limitNs % 1000000000LL;
+        wskLimitu = &limit;
+    }
+    syscall(SYS_futex, reinterpret_cast<int*>(&slowo), FUTEX_WAIT_PRIVATE, oczekiwana,
+            wskLimitu, nullptr, 0);
+#else
+    (void)slowo;
+    (void)oczekiwana;
+    (void)limitNs;
+    std::this_thread::yield();
+#endif
+}
+
+// Budzi do `ile` wątków śpiących w futexCzekaj() na tym słowie.
+inline void futexObudz(std::atomic<int>& slowo, int ile) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int*>(&slowo), FUTEX_WAKE_PRIVATE, ile,
+            nullptr, nullptr, 0);
+#else
+    (void)slowo;
+    (void)ile;
+#endif
+}
+
+// Ile obrotów pętli czekania robimy z samym PAUSE, zanim zaczniemy oddawać procesor.
+const int OBROTY_PRZED_YIELD = 256;
+
+/*
+ * Jeden obrót pętli czekania: na początku tylko PAUSE (tanie, szybka reakcja),
+ * po OBROTY_PRZED_YIELD obrotach już yield().
+ */
+inline void obrotCzekania(int& obroty) {
+    if (obroty < OBROTY_PRZED_YIELD) {
+        ++obroty;
+        pauzaProcesora();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+
+/*
+ * Blokada biletowa. lock() pobiera kolejny numer biletu i czeka, aż "okienko"
+ * wywoła jego numer. Gwarantuje kolejność FIFO (brak zagłodzenia), ale wszyscy
+ * czekający czytają tę samą zmienną `obslugiwany`, więc każde unlock() unieważnia
+ * linię pamięci u każdego czekającego.
+ */
+class BlokadaBiletowa {
+public:
+    void lock() {
+        unsigned mojBilet = nastepny.fetch_add(1, std::memory_order_relaxed);
+        int obroty = 0;
+        while (obslugiwany.load(std::memory_order_acquire) != mojBilet) {
+            obrotCzekania(obroty);
+        }
+    }
+
+    // Udaje się tylko wtedy, gdy nikt nie trzyma blokady i nikt nie stoi w kolejce.
+    bool try_lock() {
+        unsigned teraz = obslugiwany.load(std::memory_order_acquire);
+        unsigned oczekiwany = teraz;
+        return nastepny.compare_exchange_strong(oczekiwany, teraz + 1,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        // Tylko właściciel zmienia `obslugiwany`, więc wystarczy zwykły zapis.
+        obslugiwany.store(obslugiwany.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+    }
+
+private:
+    std::atomic<unsigned> nastepny{0};
+    std::atomic<unsigned> obslugiwany{0};
+};
+
+
+/*
+ * Blokada kolejkowa MCS (Mellor-Crummey, Scott). Czekający ustawiają się w liście
+ * i każdy kręci się na fladze we własnym węźle, więc przekazanie blokady dotyka
+ * tylko linii następnego w kolejce.
+ *
+ * Interfejs mutexa nie przekazuje węzła do unlock(), dlatego węzeł bierzemy
+ * z puli danego wątku, a właściciel zapisuje go w blokadzie po jej zdobyciu
+ * (pole `wezelWlasciciela` czyta i pisze tylko aktualny właściciel).
+ * Po powrocie z unlock() nikt już nie dotyka węzła, więc wraca on do puli.
+ */
+class BlokadaMCS {
+public:
+    void lock() {
+        Wezel* moj = pobierzWezel();
+        Wezel* poprzedni = ogon.exchange(moj, std::memory_order_acq_rel);
+        if (poprzedni != nullptr) {
+            // Ktoś już czeka albo trzyma - dopisujemy się za nim i czekamy na swoją flagę.
+            poprzedni->nastepny.store(moj, std::memory_order_release);
+            int obroty = 0;
+            while (moj->czeka.load(std::memory_order_acquire)) {
+                obrotCzekania(obroty);
+            }
+        }
+        wezelWlasciciela = moj;
+    }
+
+    bool try_lock() {
+        Wezel* moj = pobierzWezel();
+        Wezel* pusty = nullptr;
+        if (ogon.compare_exchange_strong(pusty, moj, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+            wezelWlasciciela = moj;
+            return true;
+        }
+        oddajWezel(moj);
+        return false;
+    }
+
+    void unlock() {
+        Wezel* moj = wezelWlasciciela;
+        Wezel* nastepca = moj->nastepny.load(std::memory_order_acquire);
+        if (nastepca == nullptr) {
+            // Jeśli nadal jesteśmy ogonem, po prostu zwalniamy blokadę.
+            Wezel* oczekiwany = moj;
+            if (ogon.compare_exchange_strong(oczekiwany, nullptr, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                oddajWezel(moj);
+                return;
+            }
+            // Ktoś właśnie się dopisuje - czekamy, aż ustawi wskaźnik na siebie.
+            int obroty = 0;
+            while ((nastepca = moj->nastepny.load(std::memory_order_acquire)) == nullptr) {
+                obrotCzekania(obroty);
+            }
+        }
+        nastepca->czeka.store(false, std::memory_order_release);
+        oddajWezel(moj);
+    }
+
+private:
+    struct Wezel {
+        std::atomic<Wezel*> nastepny{nullptr};
+        std::atomic<bool> czeka{false};
+    };
+
+    /*
+     * Pula wolnych węzłów wątku. Filozof trzyma naraz kilka pałeczek, więc potrzebuje
+     * kilku węzłów; pula rośnie tylko przy pierwszych posiłkach, potem nic nie alokuje.
+     */
+    static std::vector<std::unique_ptr<Wezel>>& pulaWatku() {
+        thread_local std::vector<std::unique_ptr<Wezel>> pula;
+        return pula;
+    }
+
+    static Wezel* pobierzWezel() {
+        auto& pula = pulaWatku();
+        Wezel* wezel;
+        if (pula.empty()) {
+            wezel = new Wezel;
+        } else {
+            wezel = pula.back().release();
+            pula.pop_back();
+        }
+        wezel->nastepny.store(nullptr, std::memory_order_relaxed);
+        wezel->czeka.store(true, std::memory_order_relaxed);
+        return wezel;
+    }
+
+    static void oddajWezel(Wezel* wezel) {
+        pulaWatku().emplace_back(wezel);
+    }
+
+    std::atomic<Wezel*> ogon{nullptr};
+    Wezel* wezelWlasciciela = nullptr;
+};
+
+
+/*
+ * Blokada "kręć się, potem śpij" oparta o futex (algorytm z "Futexes Are Tricky", Drepper).
+ * stan: 0 = wolna, 1 = zajęta, 2 = zajęta i ktoś może spać w jądrze.
+ *
+ * Przed zaśnięciem kręcimy się adaptacyjnie: limit obrotów rośnie, gdy kręcenie
+ * się opłaca (blokada zwalnia się szybko), i maleje, gdy i tak kończy się snem.
+ * Przy krótkich sekcjach krytycznych oszczędza to kosztowne wywołania systemowe,
+ * przy długich nie pali procesora na próżno.
+ */
+class BlokadaFutex {
+public:
+    void lock() {
+        int c = 0;
+        if (stan.compare_exchange_strong(c, 1, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+
+        int limit = limitObrotow.load(std::memory_order_relaxed);
+        for (int i = 0; i < limit; ++i) {
+            pauzaProcesora();
+            c = 0;
+            if (stan.load(std::memory_order_relaxed) == 0
+                && stan.compare_exchange_weak(c, 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                // Kręcenie się opłaciło - pozwalamy na dłuższe następnym razem.
+                limitObrotow.store(std::min(limit * 2 + 1, MAKS_OBROTOW), std::memory_order_relaxed);
+                return;
+            }
+        }
+        limitObrotow.store(std::max(limit / 2, MIN_OBROTOW), std::memory_order_relaxed);
+
+        // Oznaczamy blokadę jako "z czekającymi" i śpimy, dopóki nie uda się jej przejąć.
+        c = stan.exchange(2, std::memory_order_acquire);
+        while (c != 0) {
+            czekajFutex(2);
+            c = stan.exchange(2, std::memory_order_acquire);
+        }
+    }
+
+    bool try_lock() {
+        int c = 0;
+        return stan.compare_exchange_strong(c, 1, std::memory_order_acquire,
+                                            std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        // Budzimy kogoś tylko wtedy, gdy ktoś mógł zasnąć (stan 2) - inaczej bez wywołania systemowego.
+        if (stan.exchange(0, std::memory_order_release) == 2) {
+            obudzJednego();
+        }
+    }
+
+private:
+    static constexpr int MIN_OBROTOW = 16;
+    static constexpr int MAKS_OBROTOW = 4096;
+
+    void czekajFutex(int oczekiwanaWartosc) {
+        futexCzekaj(stan, oczekiwanaWartosc, -1);
+    }
+
+    void obudzJednego() {
+        futexObudz(stan, 1);
+    }
+
+    std::atomic<int> stan{0};
+    std::atomic<int> limitObrotow{100};
+};
+
+
+/*
+ * Dzwonek - pozwala wątkowi zasnąć, dopóki ktoś nie "zadzwoni" (np. nie wrzuci mu
+ * wiadomości do skrzynki), ale najdłużej do podanego limitu czasu.
+ * `numer` rośnie przy każdym dzwonku; czekający zasypia tylko, jeśli numer się nie
+ * zmienił od chwili, gdy ostatnio sprawdzał skrzynki - więc żaden dzwonek nie ginie.
+ * Dzwoniący wywołuje jądro tylko wtedy, gdy ktoś naprawdę śpi.
+ */
+class Dzwonek {
+public:
+    // Numer do zapamiętania PRZED sprawdzeniem skrzynek.
+    int numer() const { return licznik.load(std::memory_order_acquire); }
+
+    void zadzwon() {
+        // seq_cst po obu stronach: albo dzwoniący zobaczy `spi`, albo czekający nowy numer.
+        licznik.fetch_add(1, std::memory_order_seq_cst);
+        if (spi.load(std::memory_order_seq_cst)) {
+            futexObudz(licznik, 1);
+        }
+    }
+
+    // Śpi, dopóki numer jest równy `widziany`, najdłużej `limitNs` (ujemny = bez limitu).
+    void czekaj(int widziany, long long limitNs) {
+        spi.store(true, std::memory_order_seq_cst);
+        if (licznik.load(std::memory_order_seq_cst) == widziany) {
+            futexCzekaj(licznik, widziany, limitNs);
+        }
+        spi.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> licznik{0};
+    std::atomic<bool> spi{false};
+};
+
+
+/*
+ * Kolejka jeden-pisarz/jeden-czytelnik (SPSC) na buforze cyklicznym o stałym rozmiarze.
+ * Bez blokad: pisarz przesuwa tylko `ogon`, czytelnik tylko `glowa`, każdy w swojej linii.
+ * wstaw() zwraca false, gdy kolejka jest pełna.
+ */
+template <typename T, unsigned Pojemnosc>
+class KolejkaSPSC {
+public:
+    bool wstaw(const T& wartosc) {
+        unsigned o = ogon.load(std::memory_order_relaxed);
+        if (o - glowa.load(std::memory_order_acquire) == Pojemnosc) return false;
+        bufor[o % Pojemnosc] = wartosc;
+        ogon.store(o + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pobierz(T& wartosc) {
+        unsigned g = glowa.load(std::memory_order_relaxed);
+        if (g == ogon.load(std::memory_order_acquire)) return false;
+        wartosc = bufor[g % Pojemnosc];
+        glowa.store(g + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<unsigned> glowa{0};
+    alignas(64) std::atomic<unsigned> ogon{0};
+    T bufor[Pojemnosc];
+};
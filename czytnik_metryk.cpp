@@ -0,0 +1,91 @@
+/*
+ * Czytnik binarnego pliku metryk (ProjektSO1 --metryki PLIK).
+ *
+ *   CzytnikMetryk PLIK         - podsumowanie przebiegu,
+ *   CzytnikMetryk PLIK --csv   - konwersja do CSV na standardowe wyjście
+ *                                (ten sam układ kolumn, co przy --metryki PLIK.csv).
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "metryki.h"
+
+using namespace std;
+
+
+int wypiszCsv(CzytnikMetryk& czytnik) {
+    vector<char> bufor;
+    dopiszNaglowekCsv(bufor, (int)czytnik.opis().filozofow, (int)czytnik.opis().paleczek);
+    while (czytnik.nastepna()) {
+        dopiszWierszCsv(bufor, czytnik.probkaBiezaca());
+        if (bufor.size() >= ZapisMetryk::PROG_ZAPISU) {
+            fwrite(bufor.data(), 1, bufor.size(), stdout);
+            bufor.clear();
+        }
+    }
+    fwrite(bufor.data(), 1, bufor.size(), stdout);
+    return 0;
+}
+
+int wypiszPodsumowanie(CzytnikMetryk& czytnik) {
+    const NaglowekMetryk& opis = czytnik.opis();
+    long long probek = 0;
+    long long posilkiPoprzednie = 0;
+    uint64_t czasPoprzedni = 0;
+    double minTempo = 0, maksTempo = 0;
+    long long maksGlodnych = 0;
+    double sumaGlodnych = 0;
+    int minPosilkow = 0, maksPosilkow = 0;
+    while (czytnik.nastepna()) {
+        const ProbkaMetryk& probka = czytnik.probkaBiezaca();
+        long long posilki = 0;
+        for (int32_t p : probka.posilki) posilki += p;
+        // Tempo w każdym odstępie między próbkami (posiłki na sekundę).
+        if (probek > 0 && probka.czasNs > czasPoprzedni) {
+            double tempo = (double)(posilki - posilkiPoprzednie) * 1e9 / (double)(probka.czasNs - czasPoprzedni);
+            if (probek == 1 || tempo < minTempo) minTempo = tempo;
+            if (probek == 1 || tempo > maksTempo) maksTempo = tempo;
+        }
+        maksGlodnych = max<long long>(maksGlodnych, probka.glodni);
+        sumaGlodnych += probka.glodni;
+        if (!probka.posilki.empty()) {
+            auto skrajne = minmax_element(probka.posilki.begin(), probka.posilki.end());
+            minPosilkow = *skrajne.first;
+            maksPosilkow = *skrajne.second;
+        }
+        posilkiPoprzednie = posilki;
+        czasPoprzedni = probka.czasNs;
+        ++probek;
+    }
+    printf("Filozofow:              %u\n", opis.filozofow);
+    printf("Paleczek:               %u\n", opis.paleczek);
+    printf("Okres probkowania:      %.3f ms\n", opis.okresUs / 1000.0);
+    printf("Probek:                 %lld\n", probek);
+    if (probek == 0) return 0;
+    double czas = czasPoprzedni / 1e9;
+    printf("Czas przebiegu:         %.3f s\n", czas);
+    printf("Posilkow razem:         %lld\n", posilkiPoprzednie);
+    printf("Posilkow na filozofa:   min %d, max %d\n", minPosilkow, maksPosilkow);
+    if (czas > 0) printf("Posilkow/s (srednio):   %.1f\n", posilkiPoprzednie / czas);
+    if (probek > 1) printf("Posilkow/s (odstepy):   min %.1f, max %.1f\n", minTempo, maksTempo);
+    printf("Glodnych:               srednio %.1f, max %lld\n", sumaGlodnych / probek, maksGlodnych);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bool csv = argc == 3 && strcmp(argv[2], "--csv") == 0;
+    if (argc != 2 && !csv) {
+        fprintf(stderr, "Uzycie: %s PLIK [--csv]\n", argv[0]);
+        return 1;
+    }
+    CzytnikMetryk czytnik;
+    if (!czytnik.otworz(argv[1])) {
+        fprintf(stderr, "Nie udalo sie wczytac pliku metryk %s\n", argv[1]);
+        return 1;
+    }
+    return csv ? wypiszCsv(czytnik) : wypiszPodsumowanie(czytnik);
+}
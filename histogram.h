@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+ * Histogram o kubełkach logarytmicznych (w stylu HdrHistogram).
+ *
+ * Każda potęga dwójki jest podzielona na PODZIAL równych kubełków, więc błąd względny
+ * wartości odczytanej z histogramu nie przekracza 1 / PODZIAL (~3%) niezależnie od
+ * skali - tak samo dla 200 ns, jak i dla 20 s. Wartości poniżej PODZIAL są dokładne.
+ * Zapis to kilka operacji bitowych i jeden licznik, bez alokacji i bez blokad:
+ *
+ *  - zapisz()         - jeden pisarz naraz (filozof, właściciel pałeczki): zwykły odczyt
+ *                       i zapis atomowy, bez read-modify-write,
+ *  - zapiszWspolnie() - wielu pisarzy (histogram dzielony przez kilku filozofów).
+ *
+ * Czytać można w każdej chwili z innego wątku (podgląd na żywo); Rozklad scala
+ * histogramy do wyliczania percentyli.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+class HistogramLog {
+public:
+    static const int BITY_PODZIALU = 5;
+    static const int PODZIAL = 1 << BITY_PODZIALU;
+    // Największy wykładnik z osobnymi kubełkami - dalsze wartości lądują w ostatnim.
+    static const int MAKS_WYKLADNIK = 40;
+    static const int KUBELKI = (MAKS_WYKLADNIK - BITY_PODZIALU + 2) * PODZIAL;
+
+    static int kubelek(int64_t wartosc) {
+        if (wartosc < PODZIAL) return wartosc < 0 ? 0 : (int)wartosc;
+        int wykladnik = 63 - __builtin_clzll((uint64_t)wartosc);
+        if (wykladnik > MAKS_WYKLADNIK) return KUBELKI - 1;
+        int przesuniecie = wykladnik - BITY_PODZIALU;
+        return przesuniecie * PODZIAL + (int)(wartosc >> przesuniecie);
+    }
+
+    // Środek kubełka - wartość, którą podają percentyle.
+    static int64_t wartoscKubelka(int indeks) {
+        if (indeks < 2 * PODZIAL) return indeks;
+        int przesuniecie = indeks / PODZIAL - 1;
+        int64_t poczatek = (int64_t)(indeks % PODZIAL + PODZIAL) << przesuniecie;
+        return poczatek + ((int64_t)1 << przesuniecie) / 2;
+    }
+
+    void zapisz(int64_t wartosc) {
+        std::atomic<uint32_t>& licznik = liczniki[kubelek(wartosc)];
+        licznik.store(licznik.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        liczba.store(liczba.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (wartosc > maks.load(std::memory_order_relaxed)) maks.store(wartosc, std::memory_order_relaxed);
+    }
+
+    void zapiszWspolnie(int64_t wartosc) {
+        liczniki[kubelek(wartosc)].fetch_add(1, std::memory_order_relaxed);
+        liczba.fetch_add(1, std::memory_order_relaxed);
+        int64_t stary = maks.load(std::memory_order_relaxed);
+        while (wartosc > stary && !maks.compare_exchange_weak(stary, wartosc, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t liczbaPomiarow() const { return liczba.load(std::memory_order_relaxed); }
+    int64_t maksimum() const { return maks.load(std::memory_order_relaxed); }
+    uint32_t licznik(int indeks) const { return liczniki[indeks].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> liczniki[KUBELKI] = {};
+    std::atomic<uint64_t> liczba{0};
+    std::atomic<int64_t> maks{0};
+};
+
+
+// Scalone histogramy (np. wszystkich filozofów) - zwykłe liczniki, do odczytu percentyli.
+class Rozklad {
+public:
+    Rozklad() : liczniki(HistogramLog::KUBELKI, 0) {}
+
+    void dodaj(const HistogramLog& histogram) {
+        if (histogram.liczbaPomiarow() == 0) return;
+        for (int i = 0; i < HistogramLog::KUBELKI; ++i) {
+            uint32_t ile = histogram.licznik(i);
+            liczniki[i] += ile;
+            liczba += ile;
+        }
+        maks = std::max(maks, histogram.maksimum());
+    }
+
+    void wyczysc() {
+        std::fill(liczniki.begin(), liczniki.end(), 0);
+        liczba = 0;
+        maks = 0;
+    }
+
+    // Wartość, poniżej której (włącznie) leży ułamek q pomiarów. 0, gdy pusto.
+    int64_t percentyl(double q) const {
+        if (liczba == 0) return 0;
+        uint64_t prog = std::max<uint64_t>(1, (uint64_t)(q * (double)liczba + 0.5));
+        uint64_t suma = 0;
+        for (int i = 0; i < HistogramLog::KUBELKI; ++i) {
+            suma += liczniki[i];
+            if (suma >= prog) return std::min(HistogramLog::wartoscKubelka(i), maks);
+        }
+        return maks;
+    }
+
+    uint64_t liczbaPomiarow() const { return liczba; }
+    int64_t maksimum() const { return maks; }
+
+private:
+    std::vector<uint64_t> liczniki;
+    uint64_t liczba = 0;
+    int64_t maks = 0;
+};
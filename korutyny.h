@@ -0,0 +1,226 @@
+#pragma once
+
+/*
+ * Jednowątkowa pętla zdarzeń dla korutyn C++20.
+ *
+ * Filozof jako korutyna nie potrzebuje własnego stosu ani wątku: między krokami
+ * zostaje tylko jego ramka (kilkaset bajtów), więc w jednym procesie mieszczą się
+ * setki tysięcy filozofów.
+ *
+ *  - `co_await petla.spij(czas)` - budzik w kolejce priorytetowej zamiast sleep_for,
+ *  - `co_await blokada.zablokuj()` - asynchroniczny mutex z kolejką czekających (FIFO);
+ *    zwolnienie przekazuje blokadę od razu pierwszemu czekającemu,
+ *  - zegar jest wirtualny (gdy nikt nie jest gotowy, przeskakuje do najbliższego budzika,
+ *    więc długie symulacje kończą się szybko) albo rzeczywisty (do podglądu w ncurses).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <new>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+/*
+ * Uchwyt korutyny startowanej przez pętlę zdarzeń. Korutyna zaczyna uśpiona
+ * (pętla wznawia ją pierwszy raz), a ramkę niszczy dopiero destruktor uchwytu -
+ * także wtedy, gdy korutyna wciąż czeka (koniec symulacji).
+ */
+class Korutyna {
+public:
+    struct promise_type {
+        Korutyna get_return_object() {
+            return Korutyna(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        // Ramki liczymy, żeby benchmark mógł podać pamięć na filozofa.
+        static void* operator new(size_t rozmiar) {
+            bajtyRamek.fetch_add((long long)rozmiar, std::memory_order_relaxed);
+            return ::operator new(rozmiar);
+        }
+        static void operator delete(void* ramka, size_t rozmiar) {
+            bajtyRamek.fetch_sub((long long)rozmiar, std::memory_order_relaxed);
+            ::operator delete(ramka);
+        }
+        static inline std::atomic<long long> bajtyRamek{0};
+    };
+
+    Korutyna(Korutyna&& inna) noexcept : uchwyt(inna.uchwyt) { inna.uchwyt = {}; }
+    Korutyna(const Korutyna&) = delete;
+    Korutyna& operator=(const Korutyna&) = delete;
+    ~Korutyna() {
+        if (uchwyt) uchwyt.destroy();
+    }
+
+    std::coroutine_handle<> start() const { return uchwyt; }
+
+    // Suma rozmiarów żywych ramek wszystkich korutyn.
+    static long long bajtyRamek() { return promise_type::bajtyRamek.load(std::memory_order_relaxed); }
+
+private:
+    explicit Korutyna(std::coroutine_handle<promise_type> uchwyt) : uchwyt(uchwyt) {}
+    std::coroutine_handle<promise_type> uchwyt;
+};
+
+
+class PetlaZdarzen {
+public:
+    typedef std::chrono::steady_clock Zegar;
+
+    // Dlaczego uruchom() oddało sterowanie.
+    enum class Koniec { ZATRZYMANA, LIMIT_CZASU, BRAK_ZDARZEN };
+
+    explicit PetlaZdarzen(bool czasWirtualny)
+        : wirtualny(czasWirtualny), aktualny(Zegar::now()) {}
+
+    // Bieżący czas pętli (wirtualny albo rzeczywisty z początku rundy).
+    Zegar::time_point teraz() const { return aktualny; }
+
+    // Korutyna gotowa do wznowienia w najbliższej rundzie.
+    void zaplanuj(std::coroutine_handle<> korutyna) { gotowe.push_back(korutyna); }
+
+    void zaplanujNa(Zegar::time_point kiedy, std::coroutine_handle<> korutyna) {
+        budziki.push({ kiedy, numerBudzika++, korutyna });
+    }
+
+    // `co_await petla.spij(czas)`. Zerowy czas to tylko oddanie kolejki innym.
+    auto spij(Zegar::duration czas) {
+        struct Sen {
+            PetlaZdarzen& petla;
+            Zegar::duration czas;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> korutyna) {
+                if (czas <= Zegar::duration::zero()) petla.zaplanuj(korutyna);
+                else petla.zaplanujNa(petla.teraz() + czas, korutyna);
+            }
+            void await_resume() const noexcept {}
+        };
+        return Sen{ *this, czas };
+    }
+
+    /*
+     * Wznawia korutyny do czasu (pętli) `limit`, do `dziala == false` albo do chwili,
+     * w której nikt nie jest gotowy i nie ma żadnego budzika - wszyscy czekają na
+     * blokady, czyli zakleszczenie. `limitRzeczywisty` chroni przed symulacją, w której
+     * wirtualny czas stoi (same zerowe czasy) albo idzie wolniej niż rzeczywisty.
+     */
+    Koniec uruchom(const std::atomic<bool>& dziala, Zegar::time_point limit,
+                   Zegar::time_point limitRzeczywisty = Zegar::time_point::max()) {
+        while (true) {
+            if (!dziala.load(std::memory_order_relaxed)) return Koniec::ZATRZYMANA;
+            Zegar::time_point rzeczywisty = Zegar::now();
+            if (rzeczywisty >= limitRzeczywisty) return Koniec::LIMIT_CZASU;
+            if (!wirtualny) aktualny = rzeczywisty;
+
+            while (!budziki.empty() && budziki.top().kiedy <= aktualny) {
+                gotowe.push_back(budziki.top().korutyna);
+                budziki.pop();
+            }
+            if (gotowe.empty()) {
+                if (budziki.empty()) return Koniec::BRAK_ZDARZEN;
+                Zegar::time_point nastepny = budziki.top().kiedy;
+                if (nastepny > limit) {
+                    if (wirtualny) aktualny = limit;
+                    return Koniec::LIMIT_CZASU;
+                }
+                if (wirtualny) {
+                    aktualny = nastepny; // Nikt nic nie robi - przeskok do najbliższego budzika.
+                } else {
+                    // Krótkie drzemki, żeby zauważyć `dziala == false`.
+                    std::this_thread::sleep_until(std::min(nastepny, rzeczywisty + std::chrono::milliseconds(10)));
+                }
+                continue;
+            }
+            /*
+             * Runda: wznawiamy tylko tych, którzy byli gotowi na jej początku. Kto w niej
+             * odda kolejkę (spij(0)), trafia na koniec i czeka do następnej rundy.
+             */
+            size_t runda = gotowe.size();
+            for (size_t i = 0; i < runda; ++i) {
+                std::coroutine_handle<> korutyna = gotowe.front();
+                gotowe.pop_front();
+                korutyna.resume();
+            }
+            wznowienia += (long long)runda;
+        }
+    }
+
+    long long liczbaWznowien() const { return wznowienia; }
+
+private:
+    struct Budzik {
+        Zegar::time_point kiedy;
+        uint64_t numer; // Równe czasy - w kolejności zaplanowania
+        std::coroutine_handle<> korutyna;
+        bool operator>(const Budzik& inny) const {
+            return kiedy != inny.kiedy ? kiedy > inny.kiedy : numer > inny.numer;
+        }
+    };
+
+    bool wirtualny;
+    Zegar::time_point aktualny;
+    std::deque<std::coroutine_handle<>> gotowe;
+    std::priority_queue<Budzik, std::vector<Budzik>, std::greater<Budzik>> budziki;
+    uint64_t numerBudzika = 0;
+    long long wznowienia = 0;
+};
+
+
+/*
+ * Asynchroniczny mutex dla korutyn jednej pętli. Czekający nie kręcą się ani nie
+ * śpią - ich awaiter (żyjący w ramce korutyny) jest dopinany do listy, a unlock
+ * przekazuje blokadę pierwszemu z listy i planuje go w pętli. Bez alokacji.
+ */
+class BlokadaAsync {
+public:
+    struct Oczekiwanie {
+        BlokadaAsync& blokada;
+        std::coroutine_handle<> korutyna{};
+        Oczekiwanie* nastepny = nullptr;
+
+        bool await_ready() noexcept { return blokada.try_lock(); }
+        void await_suspend(std::coroutine_handle<> czekajaca) noexcept {
+            korutyna = czekajaca;
+            if (blokada.ostatni) blokada.ostatni->nastepny = this;
+            else blokada.pierwszy = this;
+            blokada.ostatni = this;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    // `co_await blokada.zablokuj()` - po wznowieniu blokada należy do nas.
+    Oczekiwanie zablokuj() { return Oczekiwanie{ *this }; }
+
+    bool try_lock() {
+        if (zajeta) return false;
+        zajeta = true;
+        return true;
+    }
+
+    void unlock(PetlaZdarzen& petla) {
+        Oczekiwanie* kolejny = pierwszy;
+        if (!kolejny) {
+            zajeta = false;
+            return;
+        }
+        // Blokada zostaje zajęta - zmienia się tylko właściciel.
+        pierwszy = kolejny->nastepny;
+        if (!pierwszy) ostatni = nullptr;
+        petla.zaplanuj(kolejny->korutyna);
+    }
+
+private:
+    bool zajeta = false;
+    Oczekiwanie* pierwszy = nullptr;
+    Oczekiwanie* ostatni = nullptr;
+};
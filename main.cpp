@@ -1,16 +1,37 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <random>
 #include <string>
 #include <atomic>
 #include <iomanip>
 #include <limits>
-#include <sstream>
 #include <vector>
+#include <array>
 #include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <ctime>
 #include <curses.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "blokady.h"
+#include "korutyny.h"
+#include "slad.h"
+#include "histogram.h"
+#include "metryki.h"
+#include "planista.h"
+#include "topologia.h"
+#include "rozmieszczenie.h"
+#include "przestrzen.h"
 
 using namespace std;
 
@@ -24,39 +45,309 @@ int CZAS_JEDZENIA_MAX_MS;
 int CZAS_MYSLENIA_MIN_MS;
 int CZAS_MYSLENIA_MAX_MS;
 
-/* Stała określająca liczbę filozofów przy stole. */
+/* Domyślna liczba filozofów przy stole (tryb interaktywny bez parametrów). */
 const int LICZBA_FILOZOFOW = 5;
 
+/*
+ * Faktyczna liczba filozofów w tej symulacji. Ustawiana raz w main() (z linii poleceń
+ * albo domyślnie LICZBA_FILOZOFOW), zanim wystartuje pierwszy wątek.
+ */
+int liczbaFilozofow = LICZBA_FILOZOFOW;
 
-/* Pamięć Współdzielona
- * Tablica muteksów reprezentujących pałeczki. Każdy mutex to "zamek",
- * który może być zablokowany tylko przez jeden wątek (filozofa) naraz.
- * Dostęp do pałeczki[i] chroni i-tą pałeczkę.
+/*
+ * Topologia stołu (opcja --topologia, topologia.h) i liczba pałeczek. Na pierścieniu
+ * pałeczek jest tyle, ilu filozofów; w innych topologiach filozof potrzebuje naraz
+ * k pałeczek, a pałeczek może być więcej niż filozofów (torus - dwa razy więcej).
  */
-mutex paleczki[LICZBA_FILOZOFOW];
+Topologia topologia;
+int liczbaPaleczek = LICZBA_FILOZOFOW;
+
 
 // Typ wyliczeniowy (enum class) definiujący możliwe stany filozofa.
 enum class StanFilozofa { MYSLI, GLODNY, JE };
-// Tablica przechowująca aktualny stan każdego filozofa. Używam do wyswietlania
-StanFilozofa stanyFilozofow[LICZBA_FILOZOFOW];
-// Tablica przechowująca ID filozofa, który trzyma daną pałeczkę (-1 = wolna).
-int wlascicielePaleczek[LICZBA_FILOZOFOW];
-// Tablica przechowująca imiona filozofów.
-string imionaFilozofow[LICZBA_FILOZOFOW] = { "Shrek", "Fiona", "Osiol", "Kot", "Smoczyca" };
 
 /*
- * Tablica atomowych liczników posiłków. `atomic<int>` gwarantuje, że operacja
- * `licznik++` jest bezpieczna wątkowo (nie wystąpi wyścig danych), nawet jeśli
- * wątek główny odczytuje licznik (`.load()`) w tym samym czasie.
+ * Rozmiar linii pamięci podręcznej. Zmienne zapisywane przez różne wątki trzymamy
+ * w osobnych liniach, żeby zapis jednego filozofa nie unieważniał linii sąsiada
+ * (false sharing).
+ */
+#ifdef __cpp_lib_hardware_interference_size
+const size_t ROZMIAR_LINII = hardware_destructive_interference_size;
+#else
+const size_t ROZMIAR_LINII = 64;
+#endif
+
+/*
+ * Pomiar czasu oczekiwania GLODNY -> JE. Każdy filozof pisze tylko do swojego wpisu,
+ * więc nie potrzeba tu żadnej blokady. Sam czas trafia do histogramu filozofa.
+ */
+struct PomiarOczekiwania {
+    chrono::steady_clock::time_point poczatekGlodu;
+};
+
+/*
+ * Histogramy opóźnień (histogram.h): oczekiwanie na jedzenie - na filozofa, trzymanie
+ * pałeczki - na pałeczkę, nieudane try_lock przed posiłkiem (strategia 2) - na filozofa.
+ * Histogram zajmuje kilka KB, więc przy dużym stole filozof / pałeczka i pisze do
+ * histogramu i % LIMIT_HISTOGRAMOW, dzielonego z innymi (zapis przez fetch_add).
+ */
+const int LIMIT_HISTOGRAMOW = 1024;
+vector<HistogramLog> histogramyOczekiwania;
+vector<HistogramLog> histogramyTrzymania;
+vector<HistogramLog> histogramyPorazek;
+bool histogramyWspolne = false;
+/*
+ * Przekazanie pałeczki (opcja --przypiecie): czas od oddania pałeczki przez jednego
+ * filozofa do jej wzięcia przez sąsiada, który już na nią czekał w lock() - na filozofa
+ * biorącego. Tablica jest pusta, gdy pomiar jest wyłączony.
+ */
+bool pomiarPrzekazan = false;
+vector<HistogramLog> histogramyPrzekazania;
+
+
+/* Pamięć Współdzielona
+ * Pałeczka = zamek, który może być zablokowany tylko przez jeden wątek naraz
+ * (domyślnie mutex, inne polityki w blokady.h) plus informacja, kto ją trzyma
+ * (-1 = wolna, tylko do wyświetlania).
+ * Wszystkie pola dotyka ten sam wątek (aktualny właściciel), więc leżą w jednej linii,
+ * a każda pałeczka ma własną linię - sąsiednie pałeczki nie "przepychają" się między rdzeniami.
+ * Metody lock/try_lock/unlock pozwalają używać pałeczki dokładnie jak mutexa.
+ */
+template <typename Blokada>
+struct alignas(ROZMIAR_LINII) Paleczka {
+    Blokada blokada;
+    atomic<int> wlasciciel{-1};
+    chrono::steady_clock::time_point wzieta; // Pisze tylko właściciel - do histogramu trzymania
+    chrono::steady_clock::time_point oddana; // Pisze oddający, czyta następny właściciel - przekazanie
+
+    void lock() { blokada.lock(); }
+    bool try_lock() { return blokada.try_lock(); }
+    void unlock() { blokada.unlock(); }
+};
+
+// Dostępne polityki blokady pałeczek (wybierane opcją --blokada).
+enum class RodzajBlokady { MUTEX, BILETOWA, MCS, FUTEX };
+
+/*
+ * Na czym działają filozofowie (opcja --wykonanie): wątek na filozofa, zadania
+ * na puli pracowników (planista.h) albo korutyny na pętli zdarzeń (korutyny.h).
+ */
+enum class Wykonanie { WATKI, ZADANIA, KORUTYNY };
+
+/*
+ * Pałeczka w trybie korutyn - wszystkie korutyny działają na jednym wątku pętli,
+ * więc pałeczki nie potrzebują osobnych linii pamięci (liczy się pamięć na filozofa).
+ */
+struct PaleczkaKorutyny {
+    BlokadaAsync blokada;
+    atomic<int> wlasciciel{-1};
+    chrono::steady_clock::time_point wzieta;
+};
+
+/*
+ * Miejsce przy stole - wszystko, co pisze tylko jeden filozof: jego stan, licznik
+ * posiłków (`atomic<int>`, żeby wątek główny mógł go czytać w trakcie) i pomiar
+ * czasu oczekiwania. Jedno miejsce = osobna linia pamięci, więc `licznikPosilkow++`
+ * filozofa i nie unieważnia linii filozofa i+1.
+ */
+struct alignas(ROZMIAR_LINII) MiejsceFilozofa {
+    atomic<StanFilozofa> stan{StanFilozofa::MYSLI};
+    atomic<int> licznikPosilkow{0};
+    PomiarOczekiwania pomiar;
+};
+
+/*
+ * Tablice współdzielone. Dostęp do paleczki[i] chroni i-tą pałeczkę.
+ * Rozmiar ustalany w przygotujStol(), bo liczba filozofów nie jest już stała.
+ * Pałeczki są osobną tablicą dla każdej polityki blokady (szablon zmiennej),
+ * używana jest tylko ta wybrana przy starcie.
+ * Stan i właściciele to warstwa obserwacji - każdy wpis ma jednego pisarza naraz
+ * (stan pisze sam filozof, właściciela ten, kto trzyma mutex pałeczki), więc
+ * publikacja nie wymaga wspólnej blokady, a wątek rysujący nikogo nie blokuje.
+ */
+template <typename Blokada>
+vector<Paleczka<Blokada>> paleczkiStolu;
+vector<MiejsceFilozofa> miejsca;
+vector<PaleczkaKorutyny> paleczkiKorutyn;
+/*
+ * Wskaźniki na pola `wlasciciel` pałeczek wybranej polityki - dzięki nim kod,
+ * który nie jest szablonem (wyświetlanie, statystyki), nie musi znać typu blokady.
+ */
+vector<atomic<int>*> wlascicielePaleczek;
+vector<chrono::steady_clock::time_point*> wzieciaPaleczek;
+vector<chrono::steady_clock::time_point*> oddaniaPaleczek; // Puste przy korutynach
+RodzajBlokady rodzajBlokady = RodzajBlokady::MUTEX;
+// Tablica przechowująca imiona filozofów. Kolejni (powyżej pięciu) dostają imię z numerem.
+vector<string> imionaFilozofow = { "Shrek", "Fiona", "Osiol", "Kot", "Smoczyca" };
+
+/*
+ * Kelner (arbiter) - monitor w stylu Tanenbauma. Filozof nie sięga po pałeczki sam,
+ * tylko zgłasza kelnerowi "chcę jeść" / "skończyłem". Kelner pozwala jeść tylko wtedy,
+ * gdy żaden z sąsiadów nie je, czyli przyznaje obie pałeczki naraz.
+ *
+ * Zgłoszenia trafiają na bezblokadowy stos (push przez CAS). Kto zdobędzie blokadę
+ * kelnera, ten obsługuje od razu wszystkie zebrane zgłoszenia (flat combining) -
+ * przy dużym stole jedno przejęcie blokady obsługuje wielu filozofów, zamiast
+ * każdy z nich osobno przepychał się o wspólny mutex.
  */
-atomic<int> licznikPosilkow[LICZBA_FILOZOFOW];
+struct Zgloszenie {
+    Zgloszenie* nastepne = nullptr;
+    int idFilozofa = 0;
+    bool zwolnienie = false; // false = prośba o jedzenie, true = odkłada pałeczki
+    atomic<bool> obsluzone{false}; // Kelner już je obsłużył - zgłaszający może przestać pomagać
+};
+
+struct alignas(ROZMIAR_LINII) MiejsceUKelnera {
+    // Każdy filozof ma osobne zgłoszenie na prośbę i na zwolnienie (mogą czekać razem w jednej partii).
+    Zgloszenie prosba;
+    Zgloszenie zwolnienie;
+    // Stan widziany przez kelnera - czytany i pisany tylko pod blokadą kelnera.
+    StanFilozofa stan = StanFilozofa::MYSLI;
+    // "Semafor" filozofa - kelner podnosi go, gdy pozwala jeść.
+    mutex mutexPozwolenia;
+    condition_variable pozwolenie;
+    bool mozeJesc = false;
+};
+
+template <typename Blokada>
+struct Kelner {
+    Blokada blokada;
+    alignas(ROZMIAR_LINII) atomic<Zgloszenie*> stosZgloszen{nullptr};
+    vector<MiejsceUKelnera> miejsca;
+    // Statystyka grupowania (pisana tylko pod blokadą kelnera).
+    atomic<long long> liczbaPartii{0};
+    atomic<long long> liczbaZgloszen{0};
+
+    void przygotuj(int n) {
+        miejsca = vector<MiejsceUKelnera>(n);
+        for (int i = 0; i < n; ++i) {
+            miejsca[i].prosba.idFilozofa = i;
+            miejsca[i].zwolnienie.idFilozofa = i;
+            miejsca[i].zwolnienie.zwolnienie = true;
+        }
+        stosZgloszen.store(nullptr);
+        liczbaPartii.store(0);
+        liczbaZgloszen.store(0);
+    }
+
+    /*
+     * Wrzuca zgłoszenie na stos i dba o to, żeby ktoś je obsłużył. Jeśli blokada kelnera
+     * jest zajęta, obecny właściciel zbierze nasze zgłoszenie razem ze swoimi. Kręcimy się
+     * tylko do obsłużenia naszego zgłoszenia (flaga obsluzone), ponawiając try_lock -
+     * nie do opróżnienia stosu, bo pod obciążeniem stos prawie nigdy nie jest pusty
+     * i obsłużony już filozof obsługiwałby w kółko partie innych.
+     */
+    void zglos(Zgloszenie& zgloszenie) {
+        zgloszenie.obsluzone.store(false, memory_order_relaxed);
+        Zgloszenie* glowa = stosZgloszen.load(memory_order_relaxed);
+        do {
+            zgloszenie.nastepne = glowa;
+        } while (!stosZgloszen.compare_exchange_weak(glowa, &zgloszenie, memory_order_release,
+                                                     memory_order_relaxed));
+        int obroty = 0;
+        do {
+            if (blokada.try_lock()) {
+                obsluzZgloszenia();
+                blokada.unlock();
+            } else {
+                obrotCzekania(obroty);
+            }
+        } while (!zgloszenie.obsluzone.load(memory_order_acquire));
+    }
+
+    // Czeka, aż kelner pozwoli jeść (obie pałeczki są już nasze).
+    void czekajNaPozwolenie(int id) {
+        MiejsceUKelnera& miejsce = miejsca[id];
+        unique_lock<mutex> blokadaPozwolenia(miejsce.mutexPozwolenia);
+        miejsce.pozwolenie.wait(blokadaPozwolenia, [&] { return miejsce.mozeJesc; });
+        miejsce.mozeJesc = false;
+    }
+
+private:
+    /*
+     * Obsługuje zebrane zgłoszenia (wywoływane pod blokadą kelnera). Stos jest LIFO,
+     * więc partię odwracamy - zwolnienie filozofa musi zostać obsłużone przed jego
+     * następną prośbą. Kilka rund, żeby nie trzymać blokady w nieskończoność, gdy
+     * zgłoszenia ciągle napływają (pozostałe i tak obsłuży ktoś z czekających w zglos()).
+     */
+    void obsluzZgloszenia() {
+        for (int runda = 0; runda < 4; ++runda) {
+            Zgloszenie* partia = stosZgloszen.exchange(nullptr, memory_order_acquire);
+            if (partia == nullptr) return;
+            Zgloszenie* poKolei = nullptr;
+            while (partia != nullptr) {
+                Zgloszenie* nastepne = partia->nastepne;
+                partia->nastepne = poKolei;
+                poKolei = partia;
+                partia = nastepne;
+            }
+            long long wPartii = 0;
+            while (poKolei != nullptr) {
+                // Zapamiętujemy następne przed obsługą - filozof może od razu użyć zgłoszenia ponownie.
+                Zgloszenie* nastepne = poKolei->nastepne;
+                int id = poKolei->idFilozofa;
+                int n = (int)miejsca.size();
+                if (poKolei->zwolnienie) {
+                    miejsca[id].stan = StanFilozofa::MYSLI;
+                    sprawdz((id + n - 1) % n);
+                    sprawdz((id + 1) % n);
+                } else {
+                    miejsca[id].stan = StanFilozofa::GLODNY;
+                    sprawdz(id);
+                }
+                // Po tym zapisie zgłaszający może wrócić i użyć zgłoszenia ponownie - już go nie dotykamy.
+                poKolei->obsluzone.store(true, memory_order_release);
+                poKolei = nastepne;
+                wPartii++;
+            }
+            liczbaPartii.store(liczbaPartii.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            liczbaZgloszen.store(liczbaZgloszen.load(memory_order_relaxed) + wPartii, memory_order_relaxed);
+        }
+    }
+
+    // "test(i)" z rozwiązania Tanenbauma: głodny filozof je, jeśli żaden sąsiad nie je.
+    void sprawdz(int i) {
+        int n = (int)miejsca.size();
+        if (miejsca[i].stan == StanFilozofa::GLODNY
+            && miejsca[(i + n - 1) % n].stan != StanFilozofa::JE
+            && miejsca[(i + 1) % n].stan != StanFilozofa::JE) {
+            miejsca[i].stan = StanFilozofa::JE;
+            lock_guard<mutex> blokadaPozwolenia(miejsca[i].mutexPozwolenia);
+            miejsca[i].mozeJesc = true;
+            miejsca[i].pozwolenie.notify_one();
+        }
+    }
+};
+
+// Kelner dla każdej polityki blokady (jak paleczkiStolu) - używany tylko ten wybrany.
+template <typename Blokada>
+Kelner<Blokada> kelnerStolu;
+
+// Średnia liczba zgłoszeń obsłużonych w jednej partii przez kelnera wybranej polityki.
+template <typename Blokada>
+double sredniaPartiaKelnera() {
+    long long partie = kelnerStolu<Blokada>.liczbaPartii.load();
+    return partie > 0 ? (double)kelnerStolu<Blokada>.liczbaZgloszen.load() / partie : 0.0;
+}
 
 /*
- * Mutex chroniący dostęp do tablic `stanyFilozofow` i `wlascicielePaleczek`.
- * Zapobiega sytuacji, w której wątek główny odczytuje te tablice podczas ich modyfikacji
- * przez wątki filozofów.
+ * Chandy-Misra: każda pałeczka należy do jednego z dwóch sąsiadów, a prośby
+ * i same pałeczki krążą jako wiadomości. Filozof ma dwie skrzynki SPSC - od lewego
+ * sąsiada (wiadomości o lewej pałeczce) i od prawego (o prawej) - oraz dzwonek,
+ * którym sąsiad go budzi. Żadnej wspólnej blokady.
  */
-mutex mutexStanu;
+enum class WiadomoscCM : uint8_t { PROSBA, PALECZKA };
+
+struct alignas(ROZMIAR_LINII) MiejsceChandyMisra {
+    // Od jednego sąsiada w drodze są najwyżej dwie wiadomości (pałeczka i prośba o jej zwrot).
+    KolejkaSPSC<WiadomoscCM, 4> odLewego;
+    KolejkaSPSC<WiadomoscCM, 4> odPrawego;
+    Dzwonek dzwonek;
+};
+vector<MiejsceChandyMisra> miejscaChandyMisra;
+// Ilu filozofów Chandy-Misra jeszcze je/myśli - reszta do końca obsługuje prośby sąsiadów.
+atomic<int> aktywniChandyMisra{0};
+
 /*
  * Atomowa flaga logiczna kontrolująca działanie wszystkich pętli `while` w programie.
  * Ustawienie jej na `false` w wątku głównym powoduje bezpieczne zakończenie
@@ -64,25 +355,130 @@ mutex mutexStanu;
  */
 atomic<bool> symulacjaDziala{true};
 
+/*
+ * Zegar, według którego mierzymy czas oczekiwania. Domyślnie rzeczywisty; korutyny
+ * z czasem wirtualnym podmieniają go na zegar pętli zdarzeń.
+ */
+chrono::steady_clock::time_point (*zegarSymulacji)() = chrono::steady_clock::now;
+
+/*
+ * Ślad zdarzeń (opcja --slad): zmiany stanu filozofów oraz branie i oddawanie pałeczek,
+ * zapisywane do buforów wątków i na końcu eksportowane jako JSON dla chrome://tracing / Perfetto.
+ */
+enum class ZdarzenieFilozofa : unsigned { STAN, BIERZE, ODDAJE };
+Slad slad;
+// Łącznie tyle zdarzeń trzymamy w buforach wszystkich wątków (16 B każde).
+const size_t LIMIT_ZDARZEN_SLADU = size_t(1) << 21;
+const size_t MIN_ZDARZEN_NA_WATEK = 1024;
+
 
 //FUNKCJE POMOCNICZE
 
 
+/*
+ * Ziarno losowania (opcja --ziarno), -1 = losowe z random_device. Przy podanym ziarnie
+ * kolejne generatory dostają ziarno + swój numer - w trybie korutyn jest tylko jeden
+ * wątek, więc cała symulacja w czasie wirtualnym powtarza się co do bitu.
+ */
+long long ziarnoSymulacji = -1;
+atomic<uint32_t> numerGeneratora{0};
+
+mt19937 nowyGenerator() {
+    if (ziarnoSymulacji < 0) return mt19937(random_device{}());
+    seed_seq ziarno{ (uint32_t)ziarnoSymulacji, (uint32_t)(ziarnoSymulacji >> 32), numerGeneratora++ };
+    return mt19937(ziarno);
+}
+
+/*
+ * Generator liczb losowych danego wątku.
+ */
+mt19937& generatorWatku() {
+    // `thread_local` tworzy oddzielną instancję generatora dla każdego wątku.
+    thread_local mt19937 generator = nowyGenerator(); // Inicjalizowany przy pierwszym wywołaniu w danym wątku.
+    return generator;
+}
+
 /*
  * Losuje czas z zakresu podanego wcześńiej
  */
 int losujCzas(int min_ms, int max_ms) {
-    // `thread_local` tworzy oddzielną instancję generatora dla każdego wątku.
-    thread_local mt19937 generator(random_device{}()); // Ziarno inicjalizowane losowo przy pierwszym wywołaniu w danym wątku.
     uniform_int_distribution<int> dystrybucja(min_ms, max_ms); // Równomierny rozkład w zakresie.
-    return dystrybucja(generator); // Zwraca kolejną liczbę z sekwencji generatora.
+    return dystrybucja(generatorWatku()); // Zwraca kolejną liczbę z sekwencji generatora.
+}
+
+
+/*
+ * Przygotowuje tablice współdzielone dla `filozofow` filozofów i `paleczek` pałeczek:
+ * wolne pałeczki, wszyscy myślą, liczniki wyzerowane. Wołane przed uruchomieniem wątków.
+ */
+template <typename Blokada>
+void przygotujPaleczki(int paleczek, int filozofow) {
+    // Wektora muteksów nie da się zmienić rozmiaru (mutex nie jest przenaszalny), więc tworzymy nowy.
+    paleczkiStolu<Blokada> = vector<Paleczka<Blokada>>(paleczek);
+    wlascicielePaleczek.resize(paleczek);
+    wzieciaPaleczek.resize(paleczek);
+    oddaniaPaleczek.resize(paleczek);
+    for (int i = 0; i < paleczek; ++i) {
+        wlascicielePaleczek[i] = &paleczkiStolu<Blokada>[i].wlasciciel;
+        wzieciaPaleczek[i] = &paleczkiStolu<Blokada>[i].wzieta;
+        oddaniaPaleczek[i] = &paleczkiStolu<Blokada>[i].oddana;
+    }
+    kelnerStolu<Blokada>.przygotuj(filozofow);
+}
+
+// Korutyny mają własne pałeczki (BlokadaAsync), tablic polityk blokady nie tworzymy.
+void przygotujPaleczkiKorutyn(int n) {
+    paleczkiKorutyn = vector<PaleczkaKorutyny>(n);
+    wlascicielePaleczek.resize(n);
+    wzieciaPaleczek.resize(n);
+    oddaniaPaleczek.clear();
+    for (int i = 0; i < n; ++i) {
+        wlascicielePaleczek[i] = &paleczkiKorutyn[i].wlasciciel;
+        wzieciaPaleczek[i] = &paleczkiKorutyn[i].wzieta;
+    }
+}
+
+// Filozofowie ponad listę imion dostają imiona z numerem.
+void uzupelnijImiona(int n) {
+    for (int i = (int)imionaFilozofow.size(); i < n; ++i) {
+        imionaFilozofow.push_back("Filozof" + to_string(i));
+    }
+}
+
+// Filozofów jest `n`, pałeczek tyle, ile zasobów w topologii (ustawionej wcześniej).
+void przygotujStol(int n, RodzajBlokady rodzaj, Wykonanie wykonanie) {
+    liczbaFilozofow = n;
+    liczbaPaleczek = topologia.liczbaZasobow();
+    rodzajBlokady = rodzaj;
+    int paleczek = liczbaPaleczek;
+    // Konstruktory ustawiają: wszystkie pałeczki wolne, wszyscy myślą, liczniki wyzerowane.
+    if (wykonanie == Wykonanie::KORUTYNY) {
+        przygotujPaleczkiKorutyn(paleczek);
+    } else {
+        switch (rodzaj) {
+            case RodzajBlokady::MUTEX:    przygotujPaleczki<mutex>(paleczek, n); break;
+            case RodzajBlokady::BILETOWA: przygotujPaleczki<BlokadaBiletowa>(paleczek, n); break;
+            case RodzajBlokady::MCS:      przygotujPaleczki<BlokadaMCS>(paleczek, n); break;
+            case RodzajBlokady::FUTEX:    przygotujPaleczki<BlokadaFutex>(paleczek, n); break;
+        }
+    }
+    miejsca = vector<MiejsceFilozofa>(n);
+    // Chandy-Misra działa tylko na wątkach - przy zadaniach i korutynach skrzynki byłyby zbędne.
+    miejscaChandyMisra = vector<MiejsceChandyMisra>(wykonanie == Wykonanie::WATKI ? n : 0);
+    aktywniChandyMisra.store(n);
+    int histogramow = min(n, LIMIT_HISTOGRAMOW);
+    histogramyOczekiwania = vector<HistogramLog>(histogramow);
+    histogramyTrzymania = vector<HistogramLog>(min(paleczek, LIMIT_HISTOGRAMOW));
+    histogramyPorazek = vector<HistogramLog>(histogramow);
+    histogramyWspolne = n > LIMIT_HISTOGRAMOW || paleczek > LIMIT_HISTOGRAMOW;
+    uzupelnijImiona(n);
 }
 
 
 /*
  * Zmienia na ladny tekst
  */
-string stanNaString(StanFilozofa stan) {
+const char* stanNaString(StanFilozofa stan) {
     switch (stan) {
         case StanFilozofa::MYSLI:   return "MYSLI";
         case StanFilozofa::GLODNY:  return "GLODNY";
@@ -95,425 +491,3183 @@ string stanNaString(StanFilozofa stan) {
 // Aktualizuje bezpiecznie stan filozofa
 
 void ustawStanFilozofa(int id, StanFilozofa stan) {
-    // `lock_guard` blokuje `mutexStanu` przy tworzeniu obiektu `blokada`.
-    lock_guard<mutex> blokada(mutexStanu);
-    stanyFilozofow[id] = stan;
-    // `mutexStanu` jest automatycznie odblokowywany, gdy `blokada` wychodzi poza zakres (koniec funkcji).
+    // Zapamiętujemy moment zgłodnienia, żeby w jedz() policzyć czas oczekiwania.
+    if (stan == StanFilozofa::GLODNY) {
+        miejsca[id].pomiar.poczatekGlodu = zegarSymulacji();
+    }
+    // Publikacja stanu to jeden atomowy zapis do własnej linii - nikt na nikogo nie czeka.
+    miejsca[id].stan.store(stan, memory_order_release);
+    if (slad.wlaczony()) slad.zapisz((unsigned)ZdarzenieFilozofa::STAN, id, (unsigned)stan);
+}
+
+// Odczytuje opublikowany stan filozofa (bez blokowania).
+StanFilozofa odczytajStanFilozofa(int id) {
+    return miejsca[id].stan.load(memory_order_acquire);
+}
+
+// Histogram filozofa / pałeczki `id` (przy dużym stole dzielony z innymi).
+HistogramLog& histogramDla(vector<HistogramLog>& histogramy, int id) {
+    int i = id < (int)histogramy.size() ? id : id % (int)histogramy.size();
+    return histogramy[i];
+}
+
+void zapiszDoHistogramu(vector<HistogramLog>& histogramy, int id, int64_t wartosc) {
+    HistogramLog& histogram = histogramDla(histogramy, id);
+    if (histogramyWspolne) histogram.zapiszWspolnie(wartosc);
+    else histogram.zapisz(wartosc);
+}
+
+// Scala histogramy wszystkich filozofów / pałeczek.
+Rozklad scalHistogramy(const vector<HistogramLog>& histogramy) {
+    Rozklad rozklad;
+    for (const HistogramLog& histogram : histogramy) rozklad.dodaj(histogram);
+    return rozklad;
+}
+
+// Jedna wartość do podglądu: czas w czytelnej jednostce (ns/us/ms/s) albo zwykła liczba.
+int formatujWartosc(char* bufor, size_t rozmiar, int64_t wartosc, bool czas) {
+    if (!czas) return snprintf(bufor, rozmiar, "%lld", (long long)wartosc);
+    if (wartosc < 1000) return snprintf(bufor, rozmiar, "%lldns", (long long)wartosc);
+    if (wartosc < 1000000) return snprintf(bufor, rozmiar, "%.1fus", wartosc / 1e3);
+    if (wartosc < 1000000000) return snprintf(bufor, rozmiar, "%.1fms", wartosc / 1e6);
+    return snprintf(bufor, rozmiar, "%.1fs", wartosc / 1e9);
+}
+
+// Percentyle do podglądu i podsumowania: "p50/p99/p999/max" (albo "p99/max", gdy !pelny).
+void formatujRozklad(char* bufor, size_t rozmiar, const Rozklad& rozklad, bool czas, bool pelny) {
+    if (rozklad.liczbaPomiarow() == 0) {
+        snprintf(bufor, rozmiar, "-");
+        return;
+    }
+    int64_t wartosci[4] = { rozklad.percentyl(0.50), rozklad.percentyl(0.99), rozklad.percentyl(0.999),
+                            rozklad.maksimum() };
+    size_t dlugosc = 0;
+    for (int k = pelny ? 0 : 1; k < 4; ++k) {
+        if (k == 2 && !pelny) continue;
+        if (dlugosc > 0 && dlugosc + 1 < rozmiar) bufor[dlugosc++] = '/';
+        int dopisane = formatujWartosc(bufor + dlugosc, rozmiar - dlugosc, wartosci[k], czas);
+        dlugosc = min(rozmiar - 1, dlugosc + (size_t)max(0, dopisane));
+    }
+}
+
+// Zapisuje czas oczekiwania filozofa (od zgłodnienia do zdobycia obu pałeczek).
+void zapiszCzasOczekiwania(int id) {
+    int64_t ns = chrono::duration_cast<chrono::nanoseconds>(
+        zegarSymulacji() - miejsca[id].pomiar.poczatekGlodu).count();
+    zapiszDoHistogramu(histogramyOczekiwania, id, ns);
+}
+
+// Strategia 2: ile razy try_lock zawiódł, zanim filozof zdobył obie pałeczki.
+void zapiszNieudaneProby(int id, int ile) {
+    zapiszDoHistogramu(histogramyPorazek, id, ile);
 }
 // Ustawai kto jest wlasciecielem pałeczki
 
 void ustawWlascicielaPaleczki(int idPaleczki, int idFilozofa) {
-    lock_guard<mutex> blokada(mutexStanu);
-    wlascicielePaleczek[idPaleczki] = idFilozofa;
+    // Czas trzymania liczy właściciel: zapamiętuje chwilę wzięcia i zapisuje przy oddaniu.
+    if (idFilozofa >= 0) {
+        *wzieciaPaleczek[idPaleczki] = zegarSymulacji();
+    } else {
+        auto teraz = zegarSymulacji();
+        zapiszDoHistogramu(histogramyTrzymania, idPaleczki, chrono::duration_cast<chrono::nanoseconds>(
+            teraz - *wzieciaPaleczek[idPaleczki]).count());
+        if (pomiarPrzekazan) *oddaniaPaleczek[idPaleczki] = teraz;
+    }
+    if (slad.wlaczony()) {
+        // Oddaje ten, kto trzymał - odczyt przed zapisem robi tylko jego wątek.
+        if (idFilozofa >= 0) {
+            slad.zapisz((unsigned)ZdarzenieFilozofa::BIERZE, idFilozofa, (unsigned)idPaleczki);
+        } else {
+            int trzymal = wlascicielePaleczek[idPaleczki]->load(memory_order_relaxed);
+            slad.zapisz((unsigned)ZdarzenieFilozofa::ODDAJE, trzymal, (unsigned)idPaleczki);
+        }
+    }
+    wlascicielePaleczek[idPaleczki]->store(idFilozofa, memory_order_release);
+}
+
+// Odczytuje, kto trzyma pałeczkę (-1 = wolna).
+int odczytajWlascicielaPaleczki(int idPaleczki) {
+    return wlascicielePaleczek[idPaleczki]->load(memory_order_acquire);
+}
+// Odczytuje licznik posiłków filozofa (bez blokowania).
+int odczytajLicznikPosilkow(int id) {
+    return miejsca[id].licznikPosilkow.load(memory_order_relaxed);
 }
 // Symuluje mylsenie z podanego wcześneij zakresu
 
-void mysl(int id) {
+/*
+ * Faza ciężka zmiennego obciążenia (opcja --fazy): filozofowie nie myślą, więc
+ * od razu znów są głodni. Przełącza ją wątek główny benchmarku.
+ */
+atomic<bool> fazaCiezka{false};
+
+// Początek myślenia bez samego czekania - zwraca, ile ms filozof ma myśleć.
+int zacznijMyslenie(int id) {
     ustawStanFilozofa(id, StanFilozofa::MYSLI);
-    int czasMyslenia = losujCzas(CZAS_MYSLENIA_MIN_MS, CZAS_MYSLENIA_MAX_MS);
+    if (fazaCiezka.load(memory_order_relaxed)) return 0;
+    return losujCzas(CZAS_MYSLENIA_MIN_MS, CZAS_MYSLENIA_MAX_MS);
+}
+
+void mysl(int id) {
+    int czasMyslenia = zacznijMyslenie(id);
     this_thread::sleep_for(chrono::milliseconds(czasMyslenia));
 }
 
 
 //Symuluje jedzenie z czasu wcześneij podanego
 
-void jedz(int id) {
+// Początek jedzenia (liczniki, stan) bez samego czekania - zwraca, ile ms filozof ma jeść.
+int zacznijJedzenie(int id) {
+    zapiszCzasOczekiwania(id);
     ustawStanFilozofa(id, StanFilozofa::JE);
     /* Zwiększ atomowy licznik posiłków dla tego filozofa. Operacja `++` jest bezpieczna wątkowo. */
-    licznikPosilkow[id]++;
-    int czasJedzenia = losujCzas(CZAS_JEDZENIA_MIN_MS, CZAS_JEDZENIA_MAX_MS);
-    this_thread::sleep_for(chrono::milliseconds(czasJedzenia));
+    miejsca[id].licznikPosilkow++;
+    return losujCzas(CZAS_JEDZENIA_MIN_MS, CZAS_JEDZENIA_MAX_MS);
 }
 
+void jedz(int id) {
+    int czasJedzenia = zacznijJedzenie(id);
+    this_thread::sleep_for(chrono::milliseconds(czasJedzenia));
+}
 
 
 
-/*Zaklezczenie wytępuje wtdy gdy wątek czeka na inne zasoby które  zajęte są przez inny wątek i w ten sposób się blokują.
- * Funkcja przyjmuj id filozofa. Żeby była możłliwość zakleszczenia musza być 4 warunki coffmana z wikipenii
- *
- * Wzajemne wykluczanie (Mutual Exclusion): Pałeczka (mutex) może być trzymana tylko przez jednego filozofa naraz. Gwarantuje to mutex::lock().
-
-Trzymanie i oczekiwanie (Hold and Wait): Filozof trzyma już jedną pałeczkę (paleczki[lewa].lock()) i czeka na drugą (paleczki[prawa].lock()). Nie odkłada pierwszej, jeśli druga jest zajęta. To kluczowe.
 
-Brak wywłaszczania (No Preemption): Pałeczki nie można filozofowi "wyrwać". Może ją zwolnić tylko on sam, dobrowolnie (unlock()), po zakończeniu jedzenia.
+/*
+ * Czekanie na pałeczkę - dane dla strażnika zakleszczeń (opcja --straznik).
+ * Filozof przed lock() zapisuje, na którą pałeczkę czeka i od kiedy, a po zdobyciu
+ * ją kasuje. Razem z właścicielami pałeczek daje to graf oczekiwania "kto czeka na kogo".
+ * Tablica jest pusta, gdy strażnik jest wyłączony - wtedy nic się nie zapisuje.
+ */
+struct alignas(ROZMIAR_LINII) CzekanieFilozofa {
+    atomic<int> paleczka{-1};   // -1 = nie czeka
+    atomic<int64_t> odNs{0};    // Początek czekania (steady_clock) - odróżnia kolejne czekania
+    atomic<bool> ofiara{false}; // Strażnik każe oddać trzymaną pałeczkę (odzyskiwanie)
+};
+vector<CzekanieFilozofa> czekania;
+// Czy naiwna strategia ma czekać na drugą pałeczkę przerywalnie (opcja --odzyskiwanie).
+bool odzyskiwanieZakleszczen = false;
 
-Czekanie cykliczne (Circular Wait): To jest właśnie skutek połączenia powyższych warunków z pechową synchronizacją (którą wymuszamy krótkim czasem myślenia i pauzą sleep(100)). Tworzy się zamknięty krąg:
+// Ile odczekań ofiara daje sąsiadowi na podniesienie oddanej pałeczki.
+const int PROBY_USTAPIENIA = 16;
 
-P0 (trzyma P0) czeka na P1 (trzymaną przez P1)
+void odczekajWykladniczo(int& proba);
 
-P1 (trzyma P1) czeka na P2 (trzymaną przez P2)
+/*
+ * lock() pałeczki z pomiarem przekazania: jeśli ktoś oddał ją, gdy już czekaliśmy,
+ * zapisujemy czas od oddania do naszego wzięcia (to, ile trwa przejście linii
+ * pałeczki i wybudzenie między rdzeniami). Bez czekania przekazania nie było.
+ */
+template <typename Blokada>
+void zablokujMierzac(Paleczka<Blokada>& paleczka, int id) {
+    if (!pomiarPrzekazan) {
+        paleczka.lock();
+        return;
+    }
+    auto przed = chrono::steady_clock::now();
+    paleczka.lock();
+    if (paleczka.oddana > przed) {
+        zapiszDoHistogramu(histogramyPrzekazania, id, chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - paleczka.oddana).count());
+    }
+}
 
-P2 (trzyma P2) czeka na P3 (trzymaną przez P3)
+/*
+ * Bierze pałeczkę i ustawia właściciela, odnotowując czekanie dla strażnika.
+ * `przerywalnie` zamienia lock() na odpowiednik try_lock_for: try_lock z odczekaniem
+ * wykładniczym, aż strażnik wybierze filozofa na ofiarę (albo symulacja się skończy).
+ * Zwraca false, jeśli filozof się poddał - wtedy pałeczki nie ma.
+ */
+template <typename Blokada>
+bool zablokujPaleczke(vector<Paleczka<Blokada>>& paleczki, int idPaleczki, int id, bool przerywalnie) {
+    if (czekania.empty()) {
+        zablokujMierzac(paleczki[idPaleczki], id);
+        ustawWlascicielaPaleczki(idPaleczki, id);
+        return true;
+    }
+    CzekanieFilozofa& czekanie = czekania[id];
+    czekanie.odNs.store(chrono::steady_clock::now().time_since_epoch().count(), memory_order_relaxed);
+    czekanie.paleczka.store(idPaleczki, memory_order_release);
+    bool zdobyta = true;
+    if (!przerywalnie) {
+        zablokujMierzac(paleczki[idPaleczki], id);
+    } else {
+        int proba = 0;
+        while (!paleczki[idPaleczki].try_lock()) {
+            if (czekanie.ofiara.exchange(false) || !symulacjaDziala) {
+                zdobyta = false;
+                break;
+            }
+            odczekajWykladniczo(proba);
+        }
+    }
+    czekanie.paleczka.store(-1, memory_order_release);
+    if (zdobyta) {
+        // Wyrok spóźniony - cykl i tak już pękł.
+        czekanie.ofiara.store(false, memory_order_relaxed);
+        ustawWlascicielaPaleczki(idPaleczki, id);
+    }
+    return zdobyta;
+}
 
-P3 (trzyma P3) czeka na P4 (trzymaną przez P4)
 
-P4 (trzyma P4) czeka na P0 (trzymaną przez P0)
+/*
+ * Polityka ponawiania po nieudanym try_lock() w strategii zagłodzenia (opcja --ponawianie).
+ *  BRAK        - oryginalne zachowanie: od razu kolejna próba (punkt odniesienia),
+ *  PAUZA       - kilka instrukcji PAUSE między próbami (odciąża rdzeń i magistralę),
+ *  YIELD       - oddanie procesora innym wątkom między próbami,
+ *  WYKLADNICZA - losowe odczekanie z okna, które podwaja się po każdej porażce,
+ *  STARZENIE   - jak wykładnicza, a dodatkowo filozof ustępuje głodnemu sąsiadowi,
+ *                który zjadł mniej od niego (im dłużej ktoś odstaje, tym częściej
+ *                sąsiedzi mu ustępują).
  */
-void Zakleszczenie_Filozofowie(int id) {
-    //jaką pałeczkę potrzebuje
-    int lewa = id;
-    int prawa = (id + 1) % LICZBA_FILOZOFOW;
-    //Działanie symulacji dopóki w main nie będzie false czyli przycisk q
-    while (symulacjaDziala) {
-        //ustawaimy myslenie i filozof myśli przez jakis czas
-        mysl(id);
-        //filozof jest głodny
-        ustawStanFilozofa(id, StanFilozofa::GLODNY);
-
-        //paleczka leewa jest pobierana pierwsza jeśli to możliwe i blokuuje ja a jesli nie to czeka aż będzie wolna
-        paleczki[lewa].lock(); // Czeka, jeśli zajęta
-        ustawWlascicielaPaleczki(lewa, id);
+enum class PolitykaPonawiania { BRAK, PAUZA, YIELD, WYKLADNICZA, STARZENIE };
+PolitykaPonawiania politykaPonawiania = PolitykaPonawiania::BRAK;
 
-        /*sleep dodajemy jesli chcemy żeby ta predkość komputra została zniwelowana czyli cały czs się blokowały bo czas reakcji komputera jest bardzo szybki
-            sleep daje czas innym filozofom żeby też podniesli pierwsza pałeczkę najpeirw
-        */
-        //this_thread::sleep_for(chrono::milliseconds(100));
-        /*
-         * Filozof bierze prawą pałeczkę jeśli ma już lewa i jeśli prawa jst owlna jeśli nie jes wolna to trzyma lewa i czeka aż bezie prawa zwolniona
-         */
+// Okno odczekiwania wykładniczego: od 1 us do 1 ms.
+const int ODCZEKANIE_MIN_US = 1;
+const int ODCZEKANIE_MAKS_US = 1000;
+// Krótsze odczekania kręcą się w miejscu - sleep_for i tak nie śpi krócej niż kilkadziesiąt us.
+const int ODCZEKANIE_SEN_OD_US = 50;
 
+/*
+ * Odczekanie wykładnicze z losowym rozrzutem: okno rośnie od ODCZEKANIE_MIN_US
+ * do ODCZEKANIE_MAKS_US z każdą kolejną porażką.
+ */
+int losujOdczekanieUs(int& proba) {
+    int okno = min(ODCZEKANIE_MAKS_US, ODCZEKANIE_MIN_US << min(proba, 10));
+    proba++;
+    // Losowość (jitter) rozsynchronizowuje sąsiadów, którzy przegrali w tym samym momencie.
+    return uniform_int_distribution<int>(0, okno)(generatorWatku());
+}
 
-        paleczki[prawa].lock();
-        ustawWlascicielaPaleczki(prawa, id);
+void odczekajWykladniczo(int& proba) {
+    int czekajUs = losujOdczekanieUs(proba);
+    if (czekajUs >= ODCZEKANIE_SEN_OD_US) {
+        this_thread::sleep_for(chrono::microseconds(czekajUs));
+        return;
+    }
+    auto koniec = chrono::steady_clock::now() + chrono::microseconds(czekajUs);
+    while (chrono::steady_clock::now() < koniec) {
+        pauzaProcesora();
+    }
+}
 
-        //Je jak ma 2 pałeczki
-        jedz(id);
+/*
+ * Odczekuje po nieudanej próbie zgodnie z wybraną polityką.
+ * `proba` liczy kolejne porażki w tym samym głodzie.
+ */
+void odczekajPoPorazce(int& proba) {
+    switch (politykaPonawiania) {
+        case PolitykaPonawiania::BRAK:
+            return;
+        case PolitykaPonawiania::PAUZA:
+            for (int i = 0; i < 32; ++i) pauzaProcesora();
+            return;
+        case PolitykaPonawiania::YIELD:
+            this_thread::yield();
+            return;
+        case PolitykaPonawiania::WYKLADNICZA:
+        case PolitykaPonawiania::STARZENIE:
+            break;
+    }
+    odczekajWykladniczo(proba);
+}
 
-        // oddanie pałeczek
-        ustawWlascicielaPaleczki(prawa, -1);
-        paleczki[prawa].unlock();
-        ustawWlascicielaPaleczki(lewa, -1);
-        paleczki[lewa].unlock();
+/*
+ * Czy któryś z sąsiadów (konkurentów o te same pałeczki) jest głodny i zjadł mniej od nas.
+ * Porównujemy tylko z sąsiadami, a nie ze średnią całego stołu - liczenie średniej
+ * wymagałoby wspólnego licznika albo przeglądania wszystkich miejsc przy każdej próbie.
+ * Przy remisie nikt nikomu nie ustępuje, a filozof z najmniejszą liczbą posiłków
+ * nigdy nie czeka na innych, więc nie ma zakleszczenia ani livelocka.
+ * Sąsiedzi to pozostali użytkownicy naszych pałeczek (na pierścieniu: lewy i prawy).
+ */
+bool sasiadMaPierwszenstwo(int id) {
+    int moje = odczytajLicznikPosilkow(id);
+    for (int paleczka : topologia.zasoby(id)) {
+        for (int s : topologia.uzytkownicy(paleczka)) {
+            if (s != id && odczytajStanFilozofa(s) == StanFilozofa::GLODNY && odczytajLicznikPosilkow(s) < moje) {
+                return true;
+            }
+        }
     }
+    return false;
 }
 
 
 /*
- *  W zagłodzeniu używam try_lock() żeby spróbować podnieść pałeczkę jeśli się nie uuda
- * to próbuje ponownie  co może powodować że jeden filozof będzie całyc zas
- * wyprzedzany w podnoszeniu pałeczek przez inych filozofów i bdzie mniej jadł.
- *
+ * Kolejność, w jakiej filozofowie biorą swoje pałeczki - w układzie CSR topologii
+ * (lista filozofa i zaczyna się w topologia.poczatek(i)). Liczona raz przed startem:
+ * naiwna i try_lock - kolejność deklarowana w topologii (na pierścieniu: lewa, prawa),
+ * asymetria - parzyści odwrotnie, hierarchia i adaptacyjna - rosnąco po numerze pałeczki.
  */
+vector<int> kolejnoscPobierania;
+
+void przygotujKolejnosc(int wyborLogiki) {
+    kolejnoscPobierania.resize(topologia.rozmiarCsr());
+    for (int i = 0; i < liczbaFilozofow; ++i) {
+        span<const int> zasoby = topologia.zasoby(i);
+        int* kolejnosc = kolejnoscPobierania.data() + topologia.poczatek(i);
+        copy(zasoby.begin(), zasoby.end(), kolejnosc);
+        if (wyborLogiki == 3 && i % 2 == 0) reverse(kolejnosc, kolejnosc + zasoby.size());
+        else if (wyborLogiki == 4 || wyborLogiki == 7) sort(kolejnosc, kolejnosc + zasoby.size());
+    }
+}
 
+span<const int> kolejnoscDla(int id) {
+    return { kolejnoscPobierania.data() + topologia.poczatek(id), topologia.zasoby(id).size() };
+}
 
-void Zaglodzenie_Filozofowie(int id) {
-    // jakei pałeczki podnosi jak np id =4 to paleczka 4 i 5 mod 5 czyli 0
-    int lewa = id;
-    int prawa = (id + 1) % LICZBA_FILOZOFOW;
-
+/*
+ * Strategie 1, 2 i 4 na dowolnej topologii (opcja --topologia): filozof je, gdy ma
+ * naraz wszystkie pałeczki ze swojej listy, i bierze je po kolei wg kolejnoscDla().
+ *  1 - lock() w kolejności deklarowanej; trzyma i czeka, więc każdy cykl w grafie
+ *      topologii może się zakleszczyć (z --odzyskiwanie ofiara oddaje wszystko),
+ *  2 - try_lock() po kolei, po pierwszej porażce odkłada wszystkie wzięte,
+ *  4 - lock() rosnąco po numerze pałeczki - wspólny porządek wyklucza cykl oczekiwania.
+ */
+template <typename Blokada, int Strategia>
+void Graf_Filozofowie(int id) {
+    vector<Paleczka<Blokada>>& paleczki = paleczkiStolu<Blokada>;
+    span<const int> kolejnosc = kolejnoscDla(id);
+    int k = (int)kolejnosc.size();
+    // Oddaje pierwsze `ile` pałeczek z kolejności, od ostatniej wziętej.
+    auto oddaj = [&](int ile) {
+        for (int j = ile - 1; j >= 0; --j) {
+            ustawWlascicielaPaleczki(kolejnosc[j], -1);
+            paleczki[kolejnosc[j]].unlock();
+        }
+    };
     while (symulacjaDziala) {
-
-        // ETAP MYŚLENIA
-        //    Filozof myśli przez losowy czas (2-5 sekund) żeby ich rozsynchornizować
         mysl(id);
-
-        //Jest głodny
         ustawStanFilozofa(id, StanFilozofa::GLODNY);
+        if (Strategia == 2) {
+            bool zjadl = false;
+            int proba = 0;
+            int porazki = 0;
+            while (!zjadl && symulacjaDziala) {
+                if (politykaPonawiania == PolitykaPonawiania::STARZENIE && sasiadMaPierwszenstwo(id)) {
+                    odczekajPoPorazce(proba);
+                    continue;
+                }
+                int wziete = 0;
+                while (wziete < k && paleczki[kolejnosc[wziete]].try_lock()) {
+                    ustawWlascicielaPaleczki(kolejnosc[wziete], id);
+                    wziete++;
+                }
+                if (wziete == k) {
+                    zapiszNieudaneProby(id, porazki);
+                    jedz(id);
+                    zjadl = true;
+                } else {
+                    porazki++;
+                }
+                oddaj(wziete);
+                if (!zjadl) odczekajPoPorazce(proba);
+            }
+            continue;
+        }
+        int wziete = 0;
+        while (wziete < k) {
+            // Przerywalnie czeka tylko ten, kto już coś trzyma - tylko on może zamykać cykl.
+            bool przerywalnie = Strategia == 1 && odzyskiwanieZakleszczen && wziete > 0;
+            if (zablokujPaleczke(paleczki, kolejnosc[wziete], id, przerywalnie)) {
+                wziete++;
+                continue;
+            }
+            // Ofiara strażnika: oddajemy wszystko, dajemy sąsiadom chwilę i zaczynamy od nowa.
+            oddaj(wziete);
+            wziete = 0;
+            if (!symulacjaDziala) return;
+            int proba = 0;
+            while (symulacjaDziala && odczytajWlascicielaPaleczki(kolejnosc[0]) == -1 && proba < PROBY_USTAPIENIA) {
+                odczekajWykladniczo(proba);
+            }
+        }
+        jedz(id);
+        oddaj(k);
+    }
+}
 
-        // Ustawaimy flagę czy już zjadł czy nie  jeśli nie to cały czas próbuje jesc dopóki zjadł = true albo symulacja się nie skończy
-        bool zjadl = false;
-
-        /*
-         * Pętla "spinująca".
-         * Pętla wykonuje się bardzo szybko
-         * dopóki filozofowi nie uda się zjeść (zjadl == true) lub
-         * dopóki symulacja się nie zakończy.
-         */
-        while (!zjadl && symulacjaDziala) {
-
-            // PIERWSZA PRÓBA: Sięgnij po lewą pałeczkę
-            //    `try_lock()` to funkcja "Spróbuj zamknąć".
-            //    - Jeśli pałeczka jest WOLNA: Zamyka ją i zwraca `true`.
-            //    - Jeśli pałeczka jest ZAJĘTA: NIE CZEKA. Zwraca `false`.
-            if (paleczki[lewa].try_lock()) {
 
-                ustawWlascicielaPaleczki(lewa, id);
+/*
+ * Strategie 1-4 na pierścieniu (wątki) jako klasy polityk.
+ * Polityka ma typ blokady i rozmiar stołu N jako parametry szablonu: para pałeczek
+ * każdego filozofa (w kolejności brania) leży w tablicy liczonej w czasie kompilacji,
+ * więc w pętli nie ma ani modulo, ani wyboru "lewa czy prawa najpierw". Przy N == 0
+ * (stół innej wielkości niż w rozmiarStaly) pary czytamy z kolejnoscPobierania.
+ * Pętla życia filozofa jest wspólna (Polityka_Filozofowie), polityki różnią się tylko
+ * tablicą par i sposobem zdobycia pałeczek.
+ */
+struct ParaPaleczek {
+    int pierwsza;
+    int druga;
+};
+
+// Para filozofa `id` przy stole `n` filozofów w kolejności brania przez strategię.
+template <int Strategia>
+constexpr ParaPaleczek paraNaPierscieniu(int id, int n) {
+    int lewa = id;
+    int prawa = id + 1 == n ? 0 : id + 1;
+    if constexpr (Strategia == 3) {
+        if (id % 2 == 0) return { prawa, lewa };
+    } else if constexpr (Strategia == 4) {
+        return { min(lewa, prawa), max(lewa, prawa) };
+    }
+    return { lewa, prawa };
+}
 
-                // DRUGA PRÓBA: (Trzymając lewą) Sięgnij po prawą pałeczkę
-                if (paleczki[prawa].try_lock()) {
+template <int Strategia, int N>
+struct StolPierscienia {
+    static constexpr array<ParaPaleczek, N> pary = [] {
+        array<ParaPaleczek, N> tablica{};
+        for (int i = 0; i < N; ++i) tablica[i] = paraNaPierscieniu<Strategia>(i, N);
+        return tablica;
+    }();
+
+    static ParaPaleczek para(int id) { return pary[id]; }
+};
+
+// Stół dowolnej wielkości - ta sama kolejność, policzona przy starcie (przygotujKolejnosc).
+template <int Strategia>
+struct StolPierscienia<Strategia, 0> {
+    static ParaPaleczek para(int id) {
+        span<const int> kolejnosc = kolejnoscDla(id);
+        return { kolejnosc[0], kolejnosc[1] };
+    }
+};
 
-                    ustawWlascicielaPaleczki(prawa, id);
+// Stoły, dla których tablice par są liczone w czasie kompilacji (5 - klasyczny stół).
+constexpr array<int, 3> ROZMIARY_STALE = { 5, 16, 64 };
 
-                    //  ETAP JEDZENIA jeśli zdobyliśmy obnie pałeczki
-                    jedz(id); // Je przez losowy czas
+bool rozmiarStaly(int n) {
+    return find(ROZMIARY_STALE.begin(), ROZMIARY_STALE.end(), n) != ROZMIARY_STALE.end();
+}
 
-                    // WYJŚCIE Z PĘTLI
-                    //     Ustawia flagę na `true`. Pętla 'while(!zjadl)'
-                    //     zakończy się przy następnym sprawdzeniu.
-                    zjadl = true;
-                    //odklada paleczki
-                    ustawWlascicielaPaleczki(prawa, -1);
-                    paleczki[prawa].unlock();
+/*
+ * Strategia 1 - naiwna: lock() po kolei, trzyma pierwszą i czeka na drugą. Zdobywanie
+ * (PolitykaZakleszczenia::zdobadz) spełnia wszystkie cztery warunki Coffmana, więc stół
+ * może się zakleszczyć:
+ *  - wzajemne wykluczanie - pałeczkę (mutex) trzyma naraz tylko jeden filozof,
+ *  - trzymanie i oczekiwanie - z pierwszą pałeczką w ręku filozof czeka na drugą
+ *    i nie odkłada pierwszej, gdy druga jest zajęta,
+ *  - brak wywłaszczania - pałeczkę zwalnia tylko jej właściciel (unlock() po jedzeniu),
+ *  - czekanie cykliczne - gdy wszyscy naraz wezmą pierwszą pałeczkę, filozof i czeka
+ *    na pałeczkę trzymaną przez i+1, a ostatni na pałeczkę pierwszego.
+ * Z --odzyskiwanie strażnik łamie brak wywłaszczania: ofiara oddaje pierwszą pałeczkę.
+ */
+template <typename Blokada, int N>
+struct PolitykaZakleszczenia {
+    using TypBlokady = Blokada;
+    using Stol = StolPierscienia<1, N>;
+
+    // Zwraca false, gdy symulacja skończyła się w trakcie zdobywania (nic nie trzymamy).
+    static bool zdobadz(vector<Paleczka<Blokada>>& paleczki, ParaPaleczek para, int id) {
+        zablokujPaleczke(paleczki, para.pierwsza, id, false);
+        while (!zablokujPaleczke(paleczki, para.druga, id, odzyskiwanieZakleszczen)) {
+            /*
+             * Strażnik wybrał nas na ofiarę zakleszczenia: oddajemy pierwszą, żeby cykl pękł,
+             * dajemy sąsiadowi chwilę na jej podniesienie i - wciąż głodni - bierzemy ją znowu.
+             */
+            ustawWlascicielaPaleczki(para.pierwsza, -1);
+            paleczki[para.pierwsza].unlock();
+            if (!symulacjaDziala) return false;
+            int proba = 0;
+            while (symulacjaDziala && odczytajWlascicielaPaleczki(para.pierwsza) == -1 && proba < PROBY_USTAPIENIA) {
+                odczekajWykladniczo(proba);
+            }
+            zablokujPaleczke(paleczki, para.pierwsza, id, false);
+        }
+        return true;
+    }
+};
 
-                } else {
-                    //  (Porażka z prawą) Mamy lewą, ale prawa była zajęta.
-                    //     Nie możemy jeść. Musimy odłożyć lewą.
-                    ustawWlascicielaPaleczki(lewa, -1);
+/*
+ * Strategia 2: try_lock() obu, po porażce odkłada wziętą i ponawia wg --ponawianie.
+ * Nikt nie czeka z pałeczką w ręku, więc nie ma zakleszczenia, ale filozof może być
+ * raz za razem wyprzedzany przez sąsiadów i jeść dużo rzadziej od nich (zagłodzenie).
+ */
+template <typename Blokada, int N>
+struct PolitykaZaglodzenia {
+    using TypBlokady = Blokada;
+    using Stol = StolPierscienia<2, N>;
+
+    static bool zdobadz(vector<Paleczka<Blokada>>& paleczki, ParaPaleczek para, int id) {
+        int proba = 0;
+        int porazki = 0;
+        while (symulacjaDziala) {
+            if (politykaPonawiania == PolitykaPonawiania::STARZENIE && sasiadMaPierwszenstwo(id)) {
+                odczekajPoPorazce(proba);
+                continue;
+            }
+            if (paleczki[para.pierwsza].try_lock()) {
+                ustawWlascicielaPaleczki(para.pierwsza, id);
+                if (paleczki[para.druga].try_lock()) {
+                    ustawWlascicielaPaleczki(para.druga, id);
+                    zapiszNieudaneProby(id, porazki);
+                    return true;
                 }
-
-
-                paleczki[lewa].unlock();
+                ustawWlascicielaPaleczki(para.pierwsza, -1);
+                paleczki[para.pierwsza].unlock();
             }
-
-
-            /*Filozof jest "uparty" próbuje ponownie od frazu.
-             * I znowu. I znowu. Tysiące razy na sekundę.
-            To jest "spinowanie", które marnuje jego czas procesora.
-             */
+            porazki++;
+            odczekajPoPorazce(proba);
         }
+        return false;
+    }
+};
+
+/*
+ * Strategie 3 i 4: lock() w kolejności z tablicy par - różnią się tylko nią.
+ *  - asymetria - parzyści biorą najpierw prawą, nieparzyści lewą,
+ *  - hierarchia - zawsze najpierw pałeczka o niższym numerze.
+ * Obie rozcinają cykl czekania, więc nie ma zakleszczenia, a lock() czeka w kolejce
+ * bez kręcenia się i w końcu dostaje pałeczkę - nie ma też zagłodzenia.
+ */
+template <typename Blokada, int Strategia, int N>
+struct PolitykaPorzadku {
+    using TypBlokady = Blokada;
+    using Stol = StolPierscienia<Strategia, N>;
+
+    static bool zdobadz(vector<Paleczka<Blokada>>& paleczki, ParaPaleczek para, int id) {
+        zablokujPaleczke(paleczki, para.pierwsza, id, false);
+        zablokujPaleczke(paleczki, para.druga, id, false);
+        return true;
+    }
+};
 
-        // KONIEC CYKLU
-        // Filozof wydostaje się z pętli 'while(!zjadl)' tylko wtedy, gdy udało mu się zjeść (krok 10).
-        //Teraz wraca na początek pętli życia (krok 2) i idzie myśleć.
+template <typename Polityka>
+void Polityka_Filozofowie(int id) {
+    vector<Paleczka<typename Polityka::TypBlokady>>& paleczki = paleczkiStolu<typename Polityka::TypBlokady>;
+    const ParaPaleczek para = Polityka::Stol::para(id);
+    while (symulacjaDziala) {
+        mysl(id);
+        ustawStanFilozofa(id, StanFilozofa::GLODNY);
+        if (!Polityka::zdobadz(paleczki, para, id)) return;
+        jedz(id);
+        ustawWlascicielaPaleczki(para.druga, -1);
+        paleczki[para.druga].unlock();
+        ustawWlascicielaPaleczki(para.pierwsza, -1);
+        paleczki[para.pierwsza].unlock();
     }
 }
 
 
 /*
- * Zeby nie wystapiło zaglodznie ani zakleszczenie wystarczy że zrobimy prostą amianę filozofowie o parzystym indeksie
- * najpierw próbują wziąć prawą pałeczkę a ci o nieparzystym najpierw po lewą. Używamy też lock czyli czeka aż bęzei wolna nie narnuje procesora i w końcu kiedyś dostanie dostę do pałeczki czyli nie będzie zagłodzneia
+ * Kelner (arbiter): filozof prosi kelnera o pozwolenie i czeka, aż je dostanie.
+ * Kelner przyznaje obie pałeczki naraz, tylko gdy żaden sąsiad nie je, więc nikt
+ * nie trzyma jednej pałeczki czekając na drugą - nie ma zakleszczenia.
+ * Mutexów pałeczek nie trzeba tu w ogóle blokować, wyłączność zapewnia kelner;
+ * właścicieli ustawiamy tylko do wyświetlania.
  */
-void Asymetria_Filozofowie(int id) {
+template <typename Blokada>
+void Kelner_Filozofowie(int id) {
+    Kelner<Blokada>& kelner = kelnerStolu<Blokada>;
     int lewa = id;
-    int prawa = (id + 1) % LICZBA_FILOZOFOW;
+    int prawa = (id + 1) % liczbaFilozofow;
     while (symulacjaDziala) {
         mysl(id);
         ustawStanFilozofa(id, StanFilozofa::GLODNY);
-        if (id % 2 == 0) {
-            paleczki[prawa].lock();
-            ustawWlascicielaPaleczki(prawa, id);
-            paleczki[lewa].lock();
-            ustawWlascicielaPaleczki(lewa, id);
-        } else {
-            paleczki[lewa].lock();
-            ustawWlascicielaPaleczki(lewa, id);
-            paleczki[prawa].lock();
-            ustawWlascicielaPaleczki(prawa, id);
-        }
+
+        // Prośba do kelnera i czekanie na pozwolenie (obie pałeczki naraz).
+        kelner.zglos(kelner.miejsca[id].prosba);
+        kelner.czekajNaPozwolenie(id);
+        ustawWlascicielaPaleczki(lewa, id);
+        ustawWlascicielaPaleczki(prawa, id);
+
         jedz(id);
+
+        // Oddanie pałeczek - kelner sprawdzi, czy teraz mogą jeść sąsiedzi.
         ustawWlascicielaPaleczki(prawa, -1);
-        paleczki[prawa].unlock();
         ustawWlascicielaPaleczki(lewa, -1);
-        paleczki[lewa].unlock();
+        kelner.zglos(kelner.miejsca[id].zwolnienie);
     }
 }
+
+
 /*
- * metoda Hierwarchii żeby uniknąć zakleszczenia, filozof zawsze podnosi pałeczkę
- * o niższym numerze ID jako pierwszą, a potem tę o wyższym numerze ID.
- * Używa blokującej funkcji lock(), co zapobiega zagłodzeniu.
+ * Chandy-Misra ("brudne i czyste widelce"), wersja z przekazywaniem wiadomości.
+ * Każda pałeczka jest zawsze u jednego z dwóch sąsiadów. Po jedzeniu pałeczki są brudne;
+ * brudną oddaje się na prośbę (czyszcząc ją), czystą zatrzymuje się do zjedzenia.
+ * Na początku pałeczkę dostaje sąsiad o niższym numerze - graf "kto ma pierwszeństwo"
+ * nie ma cykli i każde oddanie go odwraca, więc nie ma zakleszczenia ani zagłodzenia.
+ * Prośbę o pałeczkę może wysłać tylko ten, kto ma jej "żeton" - żeton podróżuje
+ * w przeciwną stronę niż pałeczka.
+ * Filozof rozmawia tylko z dwoma sąsiadami przez skrzynki SPSC, nie dotyka żadnej
+ * wspólnej blokady. Myśląc, dalej odpowiada na prośby (czeka na dzwonku, nie śpi).
  */
-void Hierarchia_Filozofowie(int id) {
-    /*
-     * Określenie indeksów potrzebnych pałeczek.
-     */
-    int paleczka1_id = id;
-    int paleczka2_id = (id + 1) % LICZBA_FILOZOFOW;
-
-    /*
-     * Ustalenie hierarchii podnoszenia.
-     * Używamy funkcji min() i max(), aby zawsze wiedzieć, którą podnieść jako pierwszą.
-     */
-    int pierwsza_paleczka_id = min(paleczka1_id, paleczka2_id);
-    int druga_paleczka_id = max(paleczka1_id, paleczka2_id);
+void ChandyMisra_Filozofowie(int id) {
+    const int LEWA = 0, PRAWA = 1;
+    int n = liczbaFilozofow;
+    int sasiad[2] = { (id + n - 1) % n, (id + 1) % n };
+    int paleczka[2] = { id, (id + 1) % n };
+    MiejsceChandyMisra& moje = miejscaChandyMisra[id];
+
+    struct PaleczkaCM {
+        bool mam;     // Pałeczka jest u nas
+        bool brudna;  // Używana od ostatniego przekazania
+        bool zeton;   // Mamy żeton prośby (jeśli mamy też pałeczkę - sąsiad o nią prosi)
+    } p[2];
+    for (int strona : { LEWA, PRAWA }) {
+        p[strona].mam = sasiad[strona] > id;
+        p[strona].brudna = true;
+        p[strona].zeton = !p[strona].mam;
+        if (p[strona].mam) ustawWlascicielaPaleczki(paleczka[strona], id);
+    }
+
+    auto wyslij = [&](int strona, WiadomoscCM wiadomosc) {
+        MiejsceChandyMisra& cel = miejscaChandyMisra[sasiad[strona]];
+        // Dla lewego sąsiada jesteśmy prawym sąsiadem i odwrotnie.
+        KolejkaSPSC<WiadomoscCM, 4>& skrzynka = (strona == LEWA) ? cel.odPrawego : cel.odLewego;
+        if (!skrzynka.wstaw(wiadomosc)) {
+            fprintf(stderr, "Chandy-Misra: przepelniona skrzynka filozofa %d\n", sasiad[strona]);
+            abort();
+        }
+        cel.dzwonek.zadzwon();
+    };
+
+    auto oddaj = [&](int strona) {
+        p[strona].mam = false;
+        p[strona].brudna = false; // Oddajemy wyczyszczoną
+        ustawWlascicielaPaleczki(paleczka[strona], -1);
+        wyslij(strona, WiadomoscCM::PALECZKA);
+    };
+
+    // Odbiera wiadomości i oddaje brudne pałeczki, o które ktoś prosi (chyba że właśnie jemy).
+    auto obsluzSkrzynki = [&](bool glodny) {
+        for (int strona : { LEWA, PRAWA }) {
+            KolejkaSPSC<WiadomoscCM, 4>& skrzynka = (strona == LEWA) ? moje.odLewego : moje.odPrawego;
+            WiadomoscCM wiadomosc;
+            while (skrzynka.pobierz(wiadomosc)) {
+                if (wiadomosc == WiadomoscCM::PALECZKA) {
+                    p[strona].mam = true;
+                    p[strona].brudna = false;
+                    ustawWlascicielaPaleczki(paleczka[strona], id);
+                } else {
+                    p[strona].zeton = true;
+                }
+            }
+            if (p[strona].zeton && p[strona].mam && p[strona].brudna) {
+                oddaj(strona);
+                // Głodny od razu prosi o zwrot - teraz to on ma żeton.
+                if (glodny) {
+                    p[strona].zeton = false;
+                    wyslij(strona, WiadomoscCM::PROSBA);
+                }
+            }
+        }
+    };
+
+    while (symulacjaDziala) {
+        // Myślenie - zamiast spać, czekamy na dzwonku i obsługujemy prośby sąsiadów.
+        auto koniecMyslenia = chrono::steady_clock::now()
+                            + chrono::milliseconds(losujCzas(CZAS_MYSLENIA_MIN_MS, CZAS_MYSLENIA_MAX_MS));
+        while (true) {
+            int numer = moje.dzwonek.numer();
+            obsluzSkrzynki(false);
+            auto teraz = chrono::steady_clock::now();
+            if (teraz >= koniecMyslenia || !symulacjaDziala) break;
+            moje.dzwonek.czekaj(numer, chrono::duration_cast<chrono::nanoseconds>(koniecMyslenia - teraz).count());
+        }
+
+        // Głodny: prosimy o brakujące pałeczki i czekamy, aż obie będą u nas.
+        ustawStanFilozofa(id, StanFilozofa::GLODNY);
+        for (int strona : { LEWA, PRAWA }) {
+            if (!p[strona].mam && p[strona].zeton) {
+                p[strona].zeton = false;
+                wyslij(strona, WiadomoscCM::PROSBA);
+            }
+        }
+        while (true) {
+            int numer = moje.dzwonek.numer();
+            obsluzSkrzynki(true);
+            if (p[LEWA].mam && p[PRAWA].mam) break;
+            moje.dzwonek.czekaj(numer, 100000000LL); // 100 ms - tylko zabezpieczenie
+        }
+
+        // Jedzenie - prośby, które przyjdą w tym czasie, czekają w skrzynkach.
+        jedz(id);
+        // Stan zmieniamy przed oddaniem pałeczek, żeby podgląd nie pokazał dwóch jedzących sąsiadów.
+        ustawStanFilozofa(id, StanFilozofa::MYSLI);
+        p[LEWA].brudna = true;
+        p[PRAWA].brudna = true;
+        obsluzSkrzynki(false);
+    }
+
+    /*
+     * Koniec symulacji: sąsiedzi mogą jeszcze być głodni i czekać na nasze pałeczki,
+     * więc obsługujemy prośby, dopóki wszyscy nie skończą.
+     */
+    aktywniChandyMisra--;
+    while (aktywniChandyMisra.load() > 0) {
+        int numer = moje.dzwonek.numer();
+        obsluzSkrzynki(false);
+        moje.dzwonek.czekaj(numer, 1000000LL);
+    }
+}
+
+
+/*
+ * Strategia 7 - adaptacyjna. Filozof bierze pałeczki jednym z trzech sposobów, a sposób
+ * dla całego stołu wybiera w trakcie działania wątek kontrolera (petlaKontrolera):
+ *  TRY_LOCK - optymistycznie try_lock() wszystkich, po porażce odkłada i ponawia
+ *             wg --ponawianie (jak strategia 2) - dobry, gdy pałeczki są zwykle wolne,
+ *  PORZADEK - lock() rosnąco po numerze pałeczki (jak hierarchia) - czeka bez kręcenia się,
+ *  KELNER   - najpierw pozwolenie kelnera (jak strategia 5), potem lock() w tym samym
+ *             porządku - nikt nie trzyma jednej pałeczki, czekając na sąsiada, więc przy
+ *             ciężkiej rywalizacji nie tworzą się łańcuchy czekających (tylko pierścień).
+ * Sposób filozof czyta, zanim cokolwiek weźmie, a przy try_lock także po każdej porażce
+ * (wszystko już oddał) - to jego bezpieczne punkty przełączenia. Stół się nie zatrzymuje,
+ * a przez chwilę sąsiedzi biorą pałeczki różnymi sposobami. Mieszanie jest bezpieczne:
+ * wszystkie trzy blokują muteksy pałeczek (kelner tylko do nich dopuszcza), trzymając
+ * pałeczkę czeka się tylko w porządku rosnącym, a czekający na kelnera nic nie trzyma -
+ * cykl oczekiwania nie może powstać.
+ */
+enum class SposobBrania { TRY_LOCK, PORZADEK, KELNER };
+const int LICZBA_SPOSOBOW = 3;
+atomic<SposobBrania> sposobBrania{SposobBrania::PORZADEK};
+
+/*
+ * Liczniki dla kontrolera. Każdy filozof pisze tylko swoje (osobna linia pamięci),
+ * kontroler co okres je sumuje i liczy przyrosty. Pusta tablica poza strategią 7.
+ */
+struct alignas(ROZMIAR_LINII) LicznikiAdaptacji {
+    atomic<long long> glodowTryLock{0}; // Głody w sposobie TRY_LOCK
+    atomic<long long> kolizji{0};       // ...w których pierwsze podejście się nie udało
+    atomic<SposobBrania> sposob{SposobBrania::PORZADEK}; // Sposób z ostatniego głodu
+};
+vector<LicznikiAdaptacji> licznikiAdaptacji;
+
+// Licznik z jednym pisarzem - zwykły zapis zamiast fetch_add.
+void dodajDoLicznika(atomic<long long>& licznik, long long ile) {
+    licznik.store(licznik.load(memory_order_relaxed) + ile, memory_order_relaxed);
+}
+
+template <typename Blokada>
+void Adaptacyjna_Filozofowie(int id) {
+    vector<Paleczka<Blokada>>& paleczki = paleczkiStolu<Blokada>;
+    Kelner<Blokada>& kelner = kelnerStolu<Blokada>;
+    LicznikiAdaptacji& liczniki = licznikiAdaptacji[id];
+    // Rosnąco po numerze pałeczki (przygotujKolejnosc) - wspólny porządek wszystkich sposobów.
+    span<const int> kolejnosc = kolejnoscDla(id);
+    int k = (int)kolejnosc.size();
+    auto oddaj = [&](int ile) {
+        for (int j = ile - 1; j >= 0; --j) {
+            ustawWlascicielaPaleczki(kolejnosc[j], -1);
+            paleczki[kolejnosc[j]].unlock();
+        }
+    };
+    while (symulacjaDziala) {
+        mysl(id);
+        ustawStanFilozofa(id, StanFilozofa::GLODNY);
+        SposobBrania sposob = SposobBrania::PORZADEK;
+        bool wziete = false;
+        while (!wziete) {
+            sposob = sposobBrania.load(memory_order_acquire);
+            liczniki.sposob.store(sposob, memory_order_relaxed);
+            if (sposob != SposobBrania::TRY_LOCK) {
+                if (sposob == SposobBrania::KELNER) {
+                    kelner.zglos(kelner.miejsca[id].prosba);
+                    kelner.czekajNaPozwolenie(id);
+                }
+                for (int paleczka : kolejnosc) zablokujPaleczke(paleczki, paleczka, id, false);
+                break;
+            }
+            dodajDoLicznika(liczniki.glodowTryLock, 1);
+            int proba = 0;
+            int porazki = 0;
+            // Po porażce nic nie trzymamy - jeśli kontroler zmienił sposób, od razu przechodzimy.
+            while (sposobBrania.load(memory_order_relaxed) == SposobBrania::TRY_LOCK) {
+                if (!symulacjaDziala) return;
+                if (politykaPonawiania == PolitykaPonawiania::STARZENIE && sasiadMaPierwszenstwo(id)) {
+                    odczekajPoPorazce(proba);
+                    continue;
+                }
+                int ile = 0;
+                while (ile < k && paleczki[kolejnosc[ile]].try_lock()) {
+                    ustawWlascicielaPaleczki(kolejnosc[ile], id);
+                    ile++;
+                }
+                if (ile == k) {
+                    wziete = true;
+                    break;
+                }
+                oddaj(ile);
+                // Kolizję liczymy od razu - zagłodzony filozof może nie dojść do jedzenia przez wiele okien.
+                if (porazki++ == 0) dodajDoLicznika(liczniki.kolizji, 1);
+                odczekajPoPorazce(proba);
+            }
+            if (wziete) zapiszNieudaneProby(id, porazki);
+        }
+        jedz(id);
+        oddaj(k);
+        if (sposob == SposobBrania::KELNER) kelner.zglos(kelner.miejsca[id].zwolnienie);
+    }
+}
+
+
+// Wskaźnik na funkcję z logiką filozofa (jedna ze strategii powyżej).
+typedef void (*FunkcjaFilozofa)(int);
+
+// Ile strategii można wybrać w menu / opcją --strategia.
+const int LICZBA_STRATEGII = 7;
+
+// Strategie, które działają na dowolnej topologii (pozostałe znają tylko pierścień).
+bool strategiaNaTopologii(int wyborLogiki) {
+    return wyborLogiki == 1 || wyborLogiki == 2 || wyborLogiki == 4 || wyborLogiki == 7;
+}
+
+// Strategie, które czekają na muteksy pałeczek (lock()) - tylko w nich strażnik może znaleźć cykl.
+bool strategiaCzekaNaPaleczki(int wyborLogiki) {
+    return wyborLogiki == 1 || wyborLogiki == 3 || wyborLogiki == 4 || wyborLogiki == 7;
+}
+
+// Strategie, które biorą pałeczki przez try_lock i zapisują histogram porażek.
+bool strategiaZTryLock(int wyborLogiki) {
+    return wyborLogiki == 2 || wyborLogiki == 7;
+}
+
+template <typename Blokada, int N>
+FunkcjaFilozofa politykaFilozofa(int wyborLogiki) {
+    switch (wyborLogiki) {
+        case 1: return Polityka_Filozofowie<PolitykaZakleszczenia<Blokada, N>>;
+        case 2: return Polityka_Filozofowie<PolitykaZaglodzenia<Blokada, N>>;
+        case 3: return Polityka_Filozofowie<PolitykaPorzadku<Blokada, 3, N>>;
+        case 4: return Polityka_Filozofowie<PolitykaPorzadku<Blokada, 4, N>>;
+    }
+    return nullptr;
+}
+
+/*
+ * Polityka dla bieżącego stołu: tablica par z czasu kompilacji (rozmiary sprawdzamy po kolei
+ * z ROZMIARY_STALE) albo wersja dowolnej wielkości.
+ */
+template <typename Blokada, size_t Rozmiar = 0>
+FunkcjaFilozofa politykaFilozofaDla(int wyborLogiki) {
+    if constexpr (Rozmiar == ROZMIARY_STALE.size()) {
+        return politykaFilozofa<Blokada, 0>(wyborLogiki);
+    } else {
+        if (liczbaFilozofow == ROZMIARY_STALE[Rozmiar]) {
+            return politykaFilozofa<Blokada, ROZMIARY_STALE[Rozmiar]>(wyborLogiki);
+        }
+        return politykaFilozofaDla<Blokada, Rozmiar + 1>(wyborLogiki);
+    }
+}
+
+// Wybiera funkcję logiki na podstawie numeru strategii (1-7) dla danej polityki blokady.
+template <typename Blokada>
+FunkcjaFilozofa logikaFilozofaDla(int wyborLogiki) {
+    if (!topologia.jestPierscieniem()) {
+        switch (wyborLogiki) {
+            case 1: return Graf_Filozofowie<Blokada, 1>;
+            case 2: return Graf_Filozofowie<Blokada, 2>;
+            case 4: return Graf_Filozofowie<Blokada, 4>;
+            case 7: return Adaptacyjna_Filozofowie<Blokada>;
+        }
+        return nullptr;
+    }
+    switch (wyborLogiki) {
+        case 1:
+        case 2:
+        case 3:
+        case 4: return politykaFilozofaDla<Blokada>(wyborLogiki);
+        case 5: return Kelner_Filozofowie<Blokada>;
+        case 6: return ChandyMisra_Filozofowie; // Bez pałeczek-muteksów, typ blokady bez znaczenia
+        case 7: return Adaptacyjna_Filozofowie<Blokada>;
+    }
+    return nullptr;
+}
+
+FunkcjaFilozofa logikaFilozofa(int wyborLogiki, RodzajBlokady rodzaj) {
+    switch (rodzaj) {
+        case RodzajBlokady::MUTEX:    return logikaFilozofaDla<mutex>(wyborLogiki);
+        case RodzajBlokady::BILETOWA: return logikaFilozofaDla<BlokadaBiletowa>(wyborLogiki);
+        case RodzajBlokady::MCS:      return logikaFilozofaDla<BlokadaMCS>(wyborLogiki);
+        case RodzajBlokady::FUTEX:    return logikaFilozofaDla<BlokadaFutex>(wyborLogiki);
+    }
+    return nullptr;
+}
+
+// Nazwa polityki ponawiania (opcja --ponawianie i raport benchmarku).
+const char* nazwaPonawiania(PolitykaPonawiania polityka) {
+    switch (polityka) {
+        case PolitykaPonawiania::BRAK:        return "brak";
+        case PolitykaPonawiania::PAUZA:       return "pauza";
+        case PolitykaPonawiania::YIELD:       return "yield";
+        case PolitykaPonawiania::WYKLADNICZA: return "wykladnicza";
+        case PolitykaPonawiania::STARZENIE:   return "starzenie";
+    }
+    return "?";
+}
+
+// Nazwa polityki blokady (opcja --blokada i raport benchmarku).
+const char* nazwaBlokady(RodzajBlokady rodzaj) {
+    switch (rodzaj) {
+        case RodzajBlokady::MUTEX:    return "mutex";
+        case RodzajBlokady::BILETOWA: return "biletowa";
+        case RodzajBlokady::MCS:      return "mcs";
+        case RodzajBlokady::FUTEX:    return "futex";
+    }
+    return "?";
+}
+
+// Nazwa sposobu wykonania (opcja --wykonanie i raport benchmarku).
+const char* nazwaWykonania(Wykonanie wykonanie) {
+    switch (wykonanie) {
+        case Wykonanie::WATKI:    return "watki";
+        case Wykonanie::ZADANIA:  return "zadania";
+        case Wykonanie::KORUTYNY: return "korutyny";
+    }
+    return "?";
+}
+
+// Nazwa rozmieszczenia wątków (opcja --przypiecie i raport benchmarku).
+const char* nazwaPrzypiecia(Przypiecie przypiecie) {
+    switch (przypiecie) {
+        case Przypiecie::BRAK:        return "brak";
+        case Przypiecie::ZWARTE:      return "zwarte";
+        case Przypiecie::ROTACJA:     return "rotacja";
+        case Przypiecie::ROZPROSZONE: return "rozproszone";
+    }
+    return "?";
+}
+
+// Krótka nazwa strategii do raportu benchmarku.
+const char* nazwaStrategii(int wyborLogiki) {
+    switch (wyborLogiki) {
+        case 1: return "zakleszczenie";
+        case 2: return "zaglodzenie";
+        case 3: return "asymetria";
+        case 4: return "hierarchia";
+        case 5: return "kelner";
+        case 6: return "chandy-misra";
+        case 7: return "adaptacyjna";
+    }
+    return "?";
+}
+
+/*
+ * Jak wykonywana jest strategia wątków (raport benchmarku): "polityki" z tablicą par
+ * z czasu kompilacji, "polityki-dowolny" (stół innej wielkości) albo "-" (strategie
+ * i tryby bez wersji w klasach polityk).
+ */
+const char* nazwaLogiki(int wyborLogiki, Wykonanie wykonanie) {
+    if (wykonanie != Wykonanie::WATKI || wyborLogiki > 4 || !topologia.jestPierscieniem()) return "-";
+    return rozmiarStaly(liczbaFilozofow) ? "polityki" : "polityki-dowolny";
+}
+
+/*
+ * Ustawienie zakresów czasu w zależności od wybranego trybu.
+ * To są wartości domyślne - w trybie benchmark można je nadpisać z linii poleceń.
+ */
+void ustawCzasyTrybu(int wyborLogiki) {
+    switch (wyborLogiki) {
+        case 1:
+            CZAS_MYSLENIA_MIN_MS = 2000;
+            CZAS_MYSLENIA_MAX_MS = 2000;
+            CZAS_JEDZENIA_MIN_MS = 2000;
+            CZAS_JEDZENIA_MAX_MS = 5000;
+            break;
+        default:
+            CZAS_JEDZENIA_MIN_MS = 1000;
+            CZAS_JEDZENIA_MAX_MS = 4000;
+            CZAS_MYSLENIA_MIN_MS = 2000;
+            CZAS_MYSLENIA_MAX_MS = 5000;
+            break;
+    }
+}
+
+
+//TRYB BENCHMARK (bez ncurses)
+
+
+/*
+ * Parametry uruchomienia odczytane z linii poleceń.
+ * Wartość -1 w czasach oznacza "weź domyślne dla danego trybu" (ustawCzasyTrybu).
+ */
+struct KonfiguracjaSymulacji {
+    bool benchmark = false;
+    bool weryfikacja = false;   // --weryfikuj: przeszukanie przestrzeni stanów zamiast symulacji
+    int stanowMaksMln = 64;     // Miejsce w zbiorze odwiedzonych stanów (miliony)
+    int wyborLogiki = 0;        // 0 = nie podano, w trybie interaktywnym pyta menu
+    int liczbaFilozofow = LICZBA_FILOZOFOW;
+    string topologia;           // Pusty = pierścień (opcja --topologia)
+    bool przypinanie = false;     // Podano --przypiecie (także "brak") - mierzymy przekazania
+    bool podanoPonawianie = false; // Korutyny mają własne ponawianie - tam opcję odrzucamy
+    Przypiecie przypiecie = Przypiecie::BRAK;
+    RodzajBlokady rodzajBlokady = RodzajBlokady::MUTEX;
+    PolitykaPonawiania politykaPonawiania = PolitykaPonawiania::BRAK;
+    Wykonanie wykonanie = Wykonanie::WATKI;
+    int liczbaPracownikow = 0;  // 0 = tylu, ile rdzeni
+    double czasTrwaniaS = 10.0; // Jak długo mierzymy w trybie benchmark
+    long long ziarno = -1;      // -1 = losowe
+    int straznikMs = 0;         // Okres strażnika zakleszczeń, 0 = wyłączony
+    bool odzyskiwanie = false;  // Strażnik przerywa wykryte zakleszczenia
+    string plikSladu;           // Pusty = bez śladu zdarzeń
+    string plikMetryk;          // Pusty = bez eksportu metryk
+    int okresMetrykMs = 100;
+    int okresAdaptacjiMs = 100; // Okno kontrolera strategii adaptacyjnej
+    double fazyS = 0;           // Zmiana obciążenia co tyle sekund, 0 = stałe
+    int myslenieMinMs = -1;
+    int myslenieMaxMs = -1;
+    int jedzenieMinMs = -1;
+    int jedzenieMaxMs = -1;
+};
+
+void wypiszPomoc(const char* program) {
+    cout << "Uzycie: " << program << " [opcje]" << endl;
+    cout << "  bez opcji                tryb interaktywny (menu + ncurses)" << endl;
+    cout << "  --benchmark              tryb bez ncurses, wynik jako JSON na stdout" << endl;
+    cout << "  --weryfikuj              zamiast symulacji przeszukaj wszystkie przeploty modelu strategii" << endl;
+    cout << "                           (1-5, wielowatkowy BFS z redukcja przeplotow): dowod braku" << endl;
+    cout << "                           zakleszczen albo najkrotsza sciezka do zakleszczenia" << endl;
+    cout << "  --stanow-maks N          weryfikacja: miejsce na N milionow stanow (domyslnie 64," << endl;
+    cout << "                           16 B na stan)" << endl;
+    cout << "  --strategia N            1 zakleszczenie, 2 zaglodzenie, 3 asymetria, 4 hierarchia," << endl;
+    cout << "                           5 kelner, 6 chandy-misra, 7 adaptacyjna (kontroler przelacza" << endl;
+    cout << "                           try_lock / porzadek / kelner wg rywalizacji; tylko watki)" << endl;
+    cout << "  --adaptacja-co MS        strategia 7: okno kontrolera w ms (domyslnie 100)" << endl;
+    cout << "  --filozofow N            liczba filozofow (>= 2)" << endl;
+    cout << "  --topologia OPIS         kto potrzebuje ktorych paleczek: pierscien (domyslnie)," << endl;
+    cout << "                           siatka:WxH, torus:WxH (filozof w wezle, paleczka na krawedzi;" << endl;
+    cout << "                           liczba filozofow = W*H), losowa:R:K (kazdy losuje K z R paleczek)," << endl;
+    cout << "                           plik:SCIEZKA (wiersz = paleczki filozofa); poza pierscieniem" << endl;
+    cout << "                           strategie 1, 2, 4, 7" << endl;
+    cout << "  --blokada NAZWA          typ paleczki: mutex, biletowa, mcs, futex" << endl;
+    cout << "  --ponawianie NAZWA       po porazce try_lock (strategia 2): brak, pauza, yield," << endl;
+    cout << "                           wykladnicza, starzenie; watki i zadania" << endl;
+    cout << "  --wykonanie NAZWA        watki (watek na filozofa), zadania (pula pracownikow" << endl;
+    cout << "                           z podkradaniem pracy) albo korutyny (petla zdarzen, w benchmarku" << endl;
+    cout << "                           z czasem wirtualnym); zadania i korutyny: strategie 1-4" << endl;
+    cout << "  --pracownicy N           liczba pracownikow w trybie zadan i watkow weryfikacji" << endl;
+    cout << "                           (domyslnie liczba rdzeni)" << endl;
+    cout << "  --przypiecie NAZWA       rozmieszczenie watkow filozofow na procesorach (topologia" << endl;
+    cout << "                           z sysfs): brak, zwarte (sasiedzi we wspolnej L2/L3), rotacja," << endl;
+    cout << "                           rozproszone (sasiedzi jak najdalej); mierzy tez czas" << endl;
+    cout << "                           przekazania paleczki czekajacemu sasiadowi; tylko watki" << endl;
+    cout << "  --straznik MS            wykrywanie zakleszczen (graf oczekiwania) co MS ms;" << endl;
+    cout << "                           tylko watki, strategie 1, 3, 4, 7" << endl;
+    cout << "  --odzyskiwanie           straznik przerywa zakleszczenie (naiwna strategia czeka" << endl;
+    cout << "                           na druga paleczke jak try_lock_for)" << endl;
+    cout << "  --slad PLIK              zapisz slad zdarzen (JSON dla chrome://tracing / Perfetto)" << endl;
+    cout << "  --metryki PLIK           zapisuj co okres probke metryk (posilki, stany, paleczki);" << endl;
+    cout << "                           PLIK.csv - CSV, inaczej format binarny (czytnik: CzytnikMetryk)" << endl;
+    cout << "  --metryki-co MS          okres probkowania metryk w ms (domyslnie 100, czas rzeczywisty)" << endl;
+    cout << "  --czas S                 czas pomiaru w sekundach (benchmark; korutyny: czas wirtualny)" << endl;
+    cout << "  --fazy S                 benchmark: co S sekund obciazenie zmienia sie - faza lekka" << endl;
+    cout << "                           (myslenie wg --myslenie) i ciezka (bez myslenia) na zmiane;" << endl;
+    cout << "                           bez korutyn" << endl;
+    cout << "  --ziarno N               stale ziarno losowania - korutyny w benchmarku daja" << endl;
+    cout << "                           wtedy identyczny wynik przy kazdym uruchomieniu" << endl;
+    cout << "  --myslenie MIN[:MAX]     zakres czasu myslenia w ms (0 = bez spania)" << endl;
+    cout << "  --jedzenie MIN[:MAX]     zakres czasu jedzenia w ms (0 = bez spania)" << endl;
+}
+
+// Odczytuje zakres "MIN" albo "MIN:MAX" w milisekundach.
+bool parsujZakres(const char* tekst, int& min_ms, int& max_ms) {
+    char* koniec = nullptr;
+    long a = strtol(tekst, &koniec, 10);
+    long b = a;
+    if (koniec == tekst) return false;
+    if (*koniec == ':') {
+        const char* reszta = koniec + 1;
+        b = strtol(reszta, &koniec, 10);
+        if (koniec == reszta) return false;
+    }
+    if (*koniec != '\0' || a < 0 || b < a) return false;
+    min_ms = (int)a;
+    max_ms = (int)b;
+    return true;
+}
+
+/*
+ * Parsuje argumenty linii poleceń. Zwraca false przy błędzie (wtedy wypisujemy pomoc).
+ */
+bool parsujArgumenty(int argc, char** argv, KonfiguracjaSymulacji& konfig) {
+    for (int i = 1; i < argc; ++i) {
+        string opcja = argv[i];
+        // Wszystkie opcje poza --benchmark, --weryfikuj i --odzyskiwanie biorą jedną wartość.
+        if (opcja == "--benchmark") { konfig.benchmark = true; continue; }
+        if (opcja == "--weryfikuj") { konfig.weryfikacja = true; continue; }
+        if (opcja == "--odzyskiwanie") { konfig.odzyskiwanie = true; continue; }
+        if (opcja != "--strategia" && opcja != "--filozofow" && opcja != "--blokada"
+            && opcja != "--ponawianie" && opcja != "--wykonanie" && opcja != "--pracownicy"
+            && opcja != "--czas" && opcja != "--ziarno" && opcja != "--straznik" && opcja != "--slad"
+            && opcja != "--metryki" && opcja != "--metryki-co" && opcja != "--topologia"
+            && opcja != "--myslenie" && opcja != "--jedzenie"
+            && opcja != "--przypiecie" && opcja != "--stanow-maks" && opcja != "--adaptacja-co"
+            && opcja != "--fazy") {
+            cerr << "Nieznana opcja " << opcja << endl;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Brak wartosci dla opcji " << opcja << endl;
+            return false;
+        }
+        const char* wartosc = argv[++i];
+        if (opcja == "--strategia") {
+            konfig.wyborLogiki = atoi(wartosc);
+            if (konfig.wyborLogiki < 1 || konfig.wyborLogiki > LICZBA_STRATEGII) return false;
+        } else if (opcja == "--filozofow") {
+            konfig.liczbaFilozofow = atoi(wartosc);
+            if (konfig.liczbaFilozofow < 2) return false;
+        } else if (opcja == "--topologia") {
+            konfig.topologia = wartosc;
+        } else if (opcja == "--blokada") {
+            bool znana = false;
+            for (RodzajBlokady r : { RodzajBlokady::MUTEX, RodzajBlokady::BILETOWA,
+                                     RodzajBlokady::MCS, RodzajBlokady::FUTEX }) {
+                if (strcmp(wartosc, nazwaBlokady(r)) == 0) {
+                    konfig.rodzajBlokady = r;
+                    znana = true;
+                }
+            }
+            if (!znana) return false;
+        } else if (opcja == "--ponawianie") {
+            bool znana = false;
+            for (PolitykaPonawiania p : { PolitykaPonawiania::BRAK, PolitykaPonawiania::PAUZA,
+                                          PolitykaPonawiania::YIELD, PolitykaPonawiania::WYKLADNICZA,
+                                          PolitykaPonawiania::STARZENIE }) {
+                if (strcmp(wartosc, nazwaPonawiania(p)) == 0) {
+                    konfig.politykaPonawiania = p;
+                    konfig.podanoPonawianie = true;
+                    znana = true;
+                }
+            }
+            if (!znana) return false;
+        } else if (opcja == "--wykonanie") {
+            bool znane = false;
+            for (Wykonanie w : { Wykonanie::WATKI, Wykonanie::ZADANIA, Wykonanie::KORUTYNY }) {
+                if (strcmp(wartosc, nazwaWykonania(w)) == 0) {
+                    konfig.wykonanie = w;
+                    znane = true;
+                }
+            }
+            if (!znane) return false;
+        } else if (opcja == "--przypiecie") {
+            bool znane = false;
+            for (Przypiecie p : { Przypiecie::BRAK, Przypiecie::ZWARTE, Przypiecie::ROTACJA,
+                                  Przypiecie::ROZPROSZONE }) {
+                if (strcmp(wartosc, nazwaPrzypiecia(p)) == 0) {
+                    konfig.przypiecie = p;
+                    konfig.przypinanie = true;
+                    znane = true;
+                }
+            }
+            if (!znane) return false;
+        } else if (opcja == "--stanow-maks") {
+            konfig.stanowMaksMln = atoi(wartosc);
+            if (konfig.stanowMaksMln < 1) return false;
+        } else if (opcja == "--pracownicy") {
+            konfig.liczbaPracownikow = atoi(wartosc);
+            if (konfig.liczbaPracownikow < 1) return false;
+        } else if (opcja == "--czas") {
+            konfig.czasTrwaniaS = atof(wartosc);
+            if (konfig.czasTrwaniaS <= 0) return false;
+        } else if (opcja == "--slad") {
+            konfig.plikSladu = wartosc;
+        } else if (opcja == "--metryki") {
+            konfig.plikMetryk = wartosc;
+        } else if (opcja == "--adaptacja-co") {
+            konfig.okresAdaptacjiMs = atoi(wartosc);
+            if (konfig.okresAdaptacjiMs < 1) return false;
+        } else if (opcja == "--fazy") {
+            konfig.fazyS = atof(wartosc);
+            if (konfig.fazyS <= 0) return false;
+        } else if (opcja == "--metryki-co") {
+            konfig.okresMetrykMs = atoi(wartosc);
+            if (konfig.okresMetrykMs < 1) return false;
+        } else if (opcja == "--straznik") {
+            konfig.straznikMs = atoi(wartosc);
+            if (konfig.straznikMs < 1) return false;
+        } else if (opcja == "--ziarno") {
+            char* koniec = nullptr;
+            konfig.ziarno = strtoll(wartosc, &koniec, 10);
+            if (koniec == wartosc || *koniec != '\0' || konfig.ziarno < 0) return false;
+        } else if (opcja == "--myslenie") {
+            if (!parsujZakres(wartosc, konfig.myslenieMinMs, konfig.myslenieMaxMs)) return false;
+        } else if (opcja == "--jedzenie") {
+            if (!parsujZakres(wartosc, konfig.jedzenieMinMs, konfig.jedzenieMaxMs)) return false;
+        }
+    }
+    return true;
+}
+
+// Nadpisuje czasy trybu tymi z linii poleceń (jeśli zostały podane), ustawia politykę ponawiania i ziarno.
+void zastosujKonfiguracje(const KonfiguracjaSymulacji& konfig) {
+    politykaPonawiania = konfig.politykaPonawiania;
+    ziarnoSymulacji = konfig.ziarno;
+    if (konfig.myslenieMinMs >= 0) {
+        CZAS_MYSLENIA_MIN_MS = konfig.myslenieMinMs;
+        CZAS_MYSLENIA_MAX_MS = konfig.myslenieMaxMs;
+    }
+    if (konfig.jedzenieMinMs >= 0) {
+        CZAS_JEDZENIA_MIN_MS = konfig.jedzenieMinMs;
+        CZAS_JEDZENIA_MAX_MS = konfig.jedzenieMaxMs;
+    }
+}
+
+/*
+ * Buduje topologię z opcji --topologia (bez niej - pierścień --filozofow filozofów)
+ * i ustawia liczbę filozofów na liczbę agentów topologii. Błąd wypisuje na stderr.
+ */
+bool zbudujTopologie(KonfiguracjaSymulacji& konfig) {
+    const string& opis = konfig.topologia;
+    int szerokosc = 0, wysokosc = 0, zasobow = 0, k = 0;
+    char reszta = 0;
+    if (opis.empty() || opis == "pierscien") {
+        topologia = Topologia::pierscien(konfig.liczbaFilozofow);
+    } else if (opis.rfind("siatka:", 0) == 0 || opis.rfind("torus:", 0) == 0) {
+        bool torus = opis[0] == 't';
+        const char* wymiary = opis.c_str() + (torus ? 6 : 7);
+        if (sscanf(wymiary, "%dx%d%c", &szerokosc, &wysokosc, &reszta) != 2 || szerokosc < 2 || wysokosc < 2
+            || (long long)szerokosc * wysokosc > (1 << 24)) {
+            cerr << "Zla topologia " << opis << " - oczekiwano wymiarow WxH, W, H >= 2" << endl;
+            return false;
+        }
+        topologia = Topologia::siatka(szerokosc, wysokosc, torus);
+    } else if (opis.rfind("losowa:", 0) == 0) {
+        if (sscanf(opis.c_str() + 7, "%d:%d%c", &zasobow, &k, &reszta) != 2 || k < 1 || zasobow < k
+            || zasobow > (1 << 24)) {
+            cerr << "Zla topologia " << opis << " - oczekiwano losowa:R:K, 1 <= K <= R" << endl;
+            return false;
+        }
+        // Z podanym ziarnem topologia też jest powtarzalna.
+        uint64_t ziarno = konfig.ziarno >= 0 ? (uint64_t)konfig.ziarno : random_device{}();
+        topologia = Topologia::losowa(konfig.liczbaFilozofow, zasobow, k, ziarno);
+    } else if (opis.rfind("plik:", 0) == 0) {
+        string blad;
+        if (!Topologia::zPliku(opis.substr(5), topologia, blad)) {
+            cerr << "Zla topologia " << opis << ": " << blad << endl;
+            return false;
+        }
+    } else {
+        cerr << "Nieznana topologia " << opis << endl;
+        return false;
+    }
+    konfig.liczbaFilozofow = topologia.liczbaAgentow();
+    return true;
+}
+
+//STRAŻNIK ZAKLESZCZEŃ
+
+
+/*
+ * Strażnik co `okresMs` przegląda graf oczekiwania: filozof i czeka na pałeczkę p,
+ * którą trzyma filozof j - krawędź i -> j. Każdy czeka na najwyżej jedną pałeczkę,
+ * więc z wierzchołka wychodzi najwyżej jedna krawędź i cykl znajdujemy, idąc po
+ * krawędziach. Przegląd jest przyrostowy: ruszamy tylko od filozofów, którzy zaczęli
+ * czekać od poprzedniego przeglądu (nowy cykl zawsze zamyka czyjeś nowe czekanie),
+ * i od tych, których ścieżka ostatnio urwała się na pałeczce w trakcie zmiany właściciela.
+ */
+struct Straznik {
+    int okresMs = 0;       // 0 = wyłączony
+    bool odzyskiwanie = false;
+    thread watek;
+    // Statystyki są atomowe, bo podgląd ncurses czyta je w trakcie.
+    atomic<long long> przegladow{0};
+    atomic<long long> cykli{0};
+    atomic<long long> przerwanych{0};
+    atomic<int64_t> sumaWykryciaNs{0};      // Od zamknięcia cyklu do jego wykrycia
+    atomic<int64_t> maksWykryciaNs{0};
+    atomic<int64_t> wykryciaOstatniegoNs{0};
+    atomic<int64_t> pierwszeWykrycieNs{-1}; // Chwile wykrycia liczone od startu strażnika
+    atomic<int64_t> ostatnieWykrycieNs{-1};
+    atomic<int> dlugoscOstatniegoCyklu{0};
+    double cpuS = 0.0;                      // Czas procesora strażnika, znany po zakończeniu
+};
+Straznik straznik;
+
+// Co tyle przeglądów ruszamy od wszystkich czekających - siatka bezpieczeństwa na wyścigi odczytów.
+const int PELNY_PRZEGLAD_CO = 64;
+
+// Czas procesora bieżącego wątku w sekundach.
+double czasProcesoraWatkuS() {
+    timespec czas{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &czas);
+    return czas.tv_sec + czas.tv_nsec / 1e9;
+}
+
+/*
+ * Potwierdza cykl znaleziony w przeglądzie. Pola były czytane w różnych chwilach,
+ * więc czytamy je jeszcze raz: najpierw właścicieli, potem czekania. Jeśli każdy
+ * członek jest wciąż w tym samym czekaniu (ten sam początek), to w chwili odczytu
+ * właścicieli wszyscy naraz czekali i trzymali swoje pałeczki - to prawdziwe zakleszczenie
+ * (w czasie jednego czekania filozof nie bierze ani nie oddaje pałeczek).
+ */
+bool potwierdzCykl(const vector<int>& cykl, const vector<int>& paleczkiCyklu, const vector<int64_t>& odNsCyklu) {
+    size_t k = cykl.size();
+    for (size_t i = 0; i < k; ++i) {
+        if (odczytajWlascicielaPaleczki(paleczkiCyklu[i]) != cykl[(i + 1) % k]) return false;
+    }
+    for (size_t i = 0; i < k; ++i) {
+        const CzekanieFilozofa& czekanie = czekania[cykl[i]];
+        if (czekanie.paleczka.load(memory_order_acquire) != paleczkiCyklu[i]
+            || czekanie.odNs.load(memory_order_relaxed) != odNsCyklu[i]) return false;
+    }
+    return true;
+}
+
+// Zapisuje potwierdzony cykl w statystykach i przy odzyskiwaniu wybiera ofiarę.
+void zglosCykl(const vector<int>& cykl, const vector<int64_t>& odNsCyklu, int64_t terazNs, int64_t startNs) {
+    // Cykl zamknęło najmłodsze czekanie - od niego liczymy czas wykrycia, ono też zostaje przerwane.
+    size_t najmlodszy = 0;
+    for (size_t i = 1; i < cykl.size(); ++i) {
+        if (odNsCyklu[i] > odNsCyklu[najmlodszy]) najmlodszy = i;
+    }
+    int64_t wykrycieNs = terazNs - odNsCyklu[najmlodszy];
+    straznik.cykli++;
+    straznik.sumaWykryciaNs += wykrycieNs;
+    straznik.maksWykryciaNs.store(max(straznik.maksWykryciaNs.load(), wykrycieNs));
+    straznik.wykryciaOstatniegoNs.store(wykrycieNs);
+    int64_t chwila = terazNs - startNs;
+    if (straznik.pierwszeWykrycieNs.load() < 0) straznik.pierwszeWykrycieNs.store(chwila);
+    straznik.ostatnieWykrycieNs.store(chwila);
+    straznik.dlugoscOstatniegoCyklu.store((int)cykl.size());
+    if (straznik.odzyskiwanie) {
+        czekania[cykl[najmlodszy]].ofiara.store(true, memory_order_relaxed);
+        straznik.przerwanych++;
+    }
+}
+
+void petlaStraznika() {
+    int n = liczbaFilozofow;
+    vector<int64_t> widzianeOd(n, 0);   // Początek czekania widziany w poprzednim przeglądzie
+    vector<char> ponow(n, 0);           // Ścieżka urwała się w trakcie zmiany - ruszyć znowu
+    vector<int64_t> zgloszoneOd(n, -1); // Czekanie należące do już zgłoszonego cyklu
+    vector<long long> odwiedzony(n, -1); // Numer marszu, który ostatnio przeszedł przez wierzchołek
+    vector<int> pozycja(n, 0);          // Miejsce wierzchołka na ścieżce bieżącego marszu
+    vector<int> sciezka, paleczkiSciezki;
+    vector<int64_t> odNsSciezki;
+    long long numerMarszu = 0;
+    int64_t startNs = chrono::steady_clock::now().time_since_epoch().count();
+
+    while (symulacjaDziala) {
+        this_thread::sleep_for(chrono::milliseconds(straznik.okresMs));
+        if (!symulacjaDziala) break;
+        bool pelny = straznik.przegladow.load() % PELNY_PRZEGLAD_CO == 0;
+        long long pierwszyMarsz = numerMarszu + 1;
+        for (int s = 0; s < n; ++s) {
+            int p = czekania[s].paleczka.load(memory_order_acquire);
+            if (p < 0) continue;
+            int64_t od = czekania[s].odNs.load(memory_order_relaxed);
+            bool nowe = od != widzianeOd[s];
+            widzianeOd[s] = od;
+            if (!nowe && !ponow[s] && !pelny) continue;
+            ponow[s] = 0;
+
+            // Marsz po krawędziach "czeka na właściciela" od s.
+            long long marsz = ++numerMarszu;
+            sciezka.clear();
+            paleczkiSciezki.clear();
+            odNsSciezki.clear();
+            int v = s;
+            while (true) {
+                if (odwiedzony[v] == marsz) {
+                    // Wróciliśmy na własną ścieżkę - cykl od pozycji v do końca.
+                    int j = pozycja[v];
+                    vector<int> cykl(sciezka.begin() + j, sciezka.end());
+                    vector<int> paleczkiCyklu(paleczkiSciezki.begin() + j, paleczkiSciezki.end());
+                    vector<int64_t> odNsCyklu(odNsSciezki.begin() + j, odNsSciezki.end());
+                    // Ci sami członkowie w tych samych czekaniach - ten cykl już zgłosiliśmy.
+                    bool znany = true;
+                    for (size_t i = 0; i < cykl.size(); ++i) {
+                        if (zgloszoneOd[cykl[i]] != odNsCyklu[i]) znany = false;
+                    }
+                    if (znany) break;
+                    if (potwierdzCykl(cykl, paleczkiCyklu, odNsCyklu)) {
+                        zglosCykl(cykl, odNsCyklu, chrono::steady_clock::now().time_since_epoch().count(), startNs);
+                        for (size_t i = 0; i < cykl.size(); ++i) zgloszoneOd[cykl[i]] = odNsCyklu[i];
+                    } else {
+                        ponow[s] = 1;
+                    }
+                    break;
+                }
+                if (odwiedzony[v] >= pierwszyMarsz) break; // Dalej ten przegląd już szedł
+                odwiedzony[v] = marsz;
+                pozycja[v] = (int)sciezka.size();
+                sciezka.push_back(v);
+                paleczkiSciezki.push_back(p);
+                odNsSciezki.push_back(od);
+
+                int w = odczytajWlascicielaPaleczki(p);
+                if (w < 0 || w == v) {
+                    ponow[s] = 1; // Pałeczka właśnie zmienia właściciela
+                    break;
+                }
+                p = czekania[w].paleczka.load(memory_order_acquire);
+                if (p < 0) break; // Właściciel nie czeka (je albo myśli) - tu cykl się nie zamknie
+                od = czekania[w].odNs.load(memory_order_relaxed);
+                v = w;
+            }
+        }
+        straznik.przegladow++;
+    }
+    straznik.cpuS = czasProcesoraWatkuS();
+}
+
+// Włącza zapisywanie czekań i startuje wątek strażnika (przed wątkami filozofów).
+void uruchomStraznika(int okresMs, bool odzyskiwanie) {
+    czekania = vector<CzekanieFilozofa>(liczbaFilozofow);
+    odzyskiwanieZakleszczen = odzyskiwanie;
+    straznik.okresMs = okresMs;
+    straznik.odzyskiwanie = odzyskiwanie;
+    straznik.watek = thread(petlaStraznika);
+}
+
+void zatrzymajStraznika() {
+    if (straznik.watek.joinable()) straznik.watek.join();
+}
+
+//EKSPORT METRYK
+
+
+/*
+ * Wątek eksportera (opcja --metryki): co okres zbiera liczniki posiłków, liczby
+ * filozofów w każdym stanie i właścicieli pałeczek, i dopisuje próbkę do pliku
+ * (metryki.h). Czyta tylko pola atomowe, więc nikogo nie blokuje, a na dysk
+ * pisze osobny wątek ZapisMetryk. Okres liczymy w czasie rzeczywistym.
+ */
+struct EksporterMetryk {
+    ZapisMetryk zapis;
+    int okresMs = 0;
+    chrono::steady_clock::time_point start;
+    thread watek;
+};
+EksporterMetryk eksporter;
+
+void zbierzProbke(ProbkaMetryk& probka) {
+    int n = liczbaFilozofow;
+    probka.czasNs = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - eksporter.start).count();
+    probka.posilki.resize(n);
+    probka.wlasciciele.resize(liczbaPaleczek);
+    uint32_t stany[3] = { 0, 0, 0 };
+    for (int i = 0; i < n; ++i) {
+        stany[(int)odczytajStanFilozofa(i)]++;
+        probka.posilki[i] = odczytajLicznikPosilkow(i);
+    }
+    for (int i = 0; i < liczbaPaleczek; ++i) probka.wlasciciele[i] = odczytajWlascicielaPaleczki(i);
+    probka.mysli = stany[(int)StanFilozofa::MYSLI];
+    probka.glodni = stany[(int)StanFilozofa::GLODNY];
+    probka.jedza = stany[(int)StanFilozofa::JE];
+}
+
+void petlaEksportera() {
+    ProbkaMetryk probka;
+    auto okres = chrono::milliseconds(eksporter.okresMs);
+    auto nastepna = eksporter.start;
+    while (symulacjaDziala) {
+        zbierzProbke(probka);
+        eksporter.zapis.dopisz(probka);
+        nastepna += okres;
+        // Krótkie drzemki, żeby szybko zauważyć koniec symulacji.
+        auto teraz = chrono::steady_clock::now();
+        while (symulacjaDziala && teraz < nastepna) {
+            this_thread::sleep_for(min<chrono::steady_clock::duration>(nastepna - teraz, chrono::milliseconds(10)));
+            teraz = chrono::steady_clock::now();
+        }
+    }
+    // Ostatnia próbka - stan na koniec symulacji.
+    zbierzProbke(probka);
+    eksporter.zapis.dopisz(probka);
+}
+
+// Otwiera plik metryk (PLIK.csv - CSV, inaczej binarny) i startuje eksporter.
+bool uruchomEksporter(const string& sciezka, int okresMs) {
+    bool csv = sciezka.size() >= 4 && sciezka.compare(sciezka.size() - 4, 4, ".csv") == 0;
+    if (!eksporter.zapis.otworz(sciezka, csv, liczbaFilozofow, liczbaPaleczek, (uint32_t)okresMs * 1000)) return false;
+    eksporter.okresMs = okresMs;
+    eksporter.start = chrono::steady_clock::now();
+    eksporter.watek = thread(petlaEksportera);
+    return true;
+}
+
+void zatrzymajEksporter() {
+    if (!eksporter.watek.joinable()) return;
+    eksporter.watek.join();
+    eksporter.zapis.zamknij();
+}
+
+//PRZYPIĘCIE WĄTKÓW (opcja --przypiecie)
+
+
+/*
+ * Procesor każdego filozofa (pusto = bez przypinania, decyduje planista systemu).
+ * Przypina się sam wątek filozofa na starcie, więc tryb działa tylko dla wątków.
+ */
+TopologiaProcesorow topologiaProcesorow;
+vector<int> procesoryFilozofow;
+// Wątki, których nie udało się przypiąć (cpuset cgroup, wyłączony procesor) - działają tam, gdzie je postawi system.
+atomic<int> nieudanychPrzypiec{0};
+
+/*
+ * Jak rozmieszczenie wypada dla par filozofów, którzy dzielą pałeczkę (tylko między
+ * nimi pałeczka przechodzi): ułamek par na tym samym procesorze, we wspólnej L2, L3
+ * i w tym samym gnieździe. Bez przypięcia - nieznane (par = 0).
+ */
+struct OcenaRozmieszczenia {
+    long long par = 0;
+    long long tenSamProcesor = 0;
+    long long wspolneL2 = 0;
+    long long wspolneL3 = 0;
+    long long toSamoGniazdo = 0;
+};
+
+// Czyta topologię procesorów, rozmieszcza filozofów i włącza pomiar przekazań.
+void przygotujPrzypiecie(Przypiecie tryb) {
+    topologiaProcesorow.wczytaj(TopologiaProcesorow::dozwoloneProcesory());
+    procesoryFilozofow = topologiaProcesorow.rozmiesc(tryb, liczbaFilozofow);
+    nieudanychPrzypiec = 0;
+    pomiarPrzekazan = true;
+    histogramyPrzekazania = vector<HistogramLog>(histogramyOczekiwania.size());
+}
+
+OcenaRozmieszczenia ocenRozmieszczenie() {
+    OcenaRozmieszczenia ocena;
+    if (procesoryFilozofow.empty()) return ocena;
+    for (int p = 0; p < liczbaPaleczek; ++p) {
+        span<const int> uzytkownicy = topologia.uzytkownicy(p);
+        for (size_t a = 0; a < uzytkownicy.size(); ++a) {
+            for (size_t b = a + 1; b < uzytkownicy.size(); ++b) {
+                const ProcesorLogiczny* x = topologiaProcesorow.znajdz(procesoryFilozofow[uzytkownicy[a]]);
+                const ProcesorLogiczny* y = topologiaProcesorow.znajdz(procesoryFilozofow[uzytkownicy[b]]);
+                ocena.par++;
+                ocena.tenSamProcesor += x->numer == y->numer;
+                ocena.wspolneL2 += x->domenaL2 == y->domenaL2;
+                ocena.wspolneL3 += x->domenaL3 == y->domenaL3;
+                ocena.toSamoGniazdo += x->gniazdo == y->gniazdo;
+            }
+        }
+    }
+    return ocena;
+}
+
+
+//STRATEGIA ADAPTACYJNA - kontroler
+
+
+/*
+ * Kontroler strategii 7: co okres (--adaptacja-co) sumuje liczniki filozofów i z trzech
+ * sygnałów rywalizacji wybiera sposób brania pałeczek (SposobBrania) dla całego stołu:
+ *  - oczekiwanie - średni odsetek głodnych filozofów w oknie (odczyt stanów co obrót
+ *    kontrolera), czyli jaką część czasu filozofowie czekają; mierzalne w każdym sposobie
+ *    i obejmuje też czekania, które jeszcze trwają (zagłodzonych przy try_lock),
+ *  - porażki try_lock - odsetek głodów, w których pierwsze podejście try_lock się nie
+ *    udało (tylko w sposobie TRY_LOCK; samych porażek jest tyle, ile obrotów pętli,
+ *    więc mówią więcej o tempie kręcenia się niż o rywalizacji),
+ *  - procesor - czas procesora całego procesu na rdzeń; myślenie i jedzenie śpią,
+ *    więc to prawie wyłącznie kręcenie się na pałeczkach i blokadach.
+ * Mało oczekiwania - TRY_LOCK, dużo - KELNER (na pierścieniu), pomiędzy - PORZADEK;
+ * TRY_LOCK porzucamy też wtedy, gdy większość głodów zaczyna się od porażki albo kręcenie
+ * zjada procesor - i wtedy wracamy do niego dopiero po coraz dłuższej przerwie (kara
+ * podwaja się przy każdym takim porzuceniu), żeby nie przełączać się w kółko.
+ * Okno zamyka się po okresie, ale nie przed MIN_POSILKOW_OKNA posiłkami (przy długich
+ * czasach jedzenia kilka próbek to szum). Progi w dół mają histerezę, decyzja musi się
+ * powtórzyć w POTWIERDZEN oknach z rzędu, a w sposobie zostajemy co najmniej
+ * MIN_OKIEN_W_SPOSOBIE okien. Po przełączeniu kontroler czeka, aż każdy filozof weźmie
+ * pałeczki nowym sposobem, i zapisuje tempo z pierwszego pełnego okna po przejściu.
+ */
+const double OCZEKIWANIE_LEKKIE = 0.1;
+const double OCZEKIWANIE_CIEZKIE = 0.55;
+const double HISTEREZA = 0.75;          // Próg w dół = próg w górę * HISTEREZA
+const double PORAZEK_TRY_LOCK_MAKS = 0.5;
+const double PROCESOR_MAKS = 0.5;
+const long long MIN_POSILKOW_OKNA = 16;
+const int POTWIERDZEN = 2;
+const int MIN_OKIEN_W_SPOSOBIE = 3;
+const int KARA_TRY_LOCK_MAKS = 256;     // W oknach
+
+// Sygnały z jednego okna kontrolera.
+struct OknoAdaptacji {
+    double dlugoscS = 0;
+    long long posilki = 0;
+    double posilkiNaS = 0;
+    double oczekiwanie = 0;   // Średni odsetek głodnych
+    double porazek = -1;      // Odsetek głodów z porażką try_lock, -1 = nie było głodów w TRY_LOCK
+    double procesor = 0;      // Procesor procesu na rdzeń
+};
+
+struct PrzelaczenieAdaptacji {
+    double chwilaS = 0;       // Od startu kontrolera
+    SposobBrania z = SposobBrania::PORZADEK;
+    SposobBrania na = SposobBrania::PORZADEK;
+    OknoAdaptacji przed;      // Okno, które przesądziło o przełączeniu
+    double przejscieMs = -1;  // Aż ostatni filozof wziął pałeczki nowym sposobem
+    double posilkiNaSPo = -1; // Tempo w pierwszym pełnym oknie po przejściu
+};
+
+struct KontrolerAdaptacji {
+    int okresMs = 0;          // 0 = wyłączony (strategia inna niż 7)
+    bool naBiezaco = false;   // Wypisywać przełączenia na stderr (benchmark)
+    thread watek;
+    // Dziennik i ostatnie okno czyta też podgląd ncurses.
+    mutex blokada;
+    vector<PrzelaczenieAdaptacji> przelaczenia;
+    OknoAdaptacji ostatnie;
+    long long okien = 0;
+    double czasWSposobieS[LICZBA_SPOSOBOW] = {};
+    double cpuS = 0.0;        // Czas procesora kontrolera, znany po zakończeniu
+};
+KontrolerAdaptacji kontroler;
+
+double czasProcesoraS();
+
+// Nazwa sposobu brania pałeczek (dziennik i raport benchmarku).
+const char* nazwaSposobu(SposobBrania sposob) {
+    switch (sposob) {
+        case SposobBrania::TRY_LOCK: return "try_lock";
+        case SposobBrania::PORZADEK: return "porzadek";
+        case SposobBrania::KELNER:   return "kelner";
+    }
+    return "?";
+}
+
+// TRY_LOCK kosztuje więcej, niż daje: większość głodów zaczyna się od porażki albo kręcenie zjada procesor.
+bool tryLockZaDrogi(const OknoAdaptacji& okno) {
+    return okno.porazek > PORAZEK_TRY_LOCK_MAKS || okno.procesor > PROCESOR_MAKS;
+}
+
+// Sposób, na który kontroler chce przejść po oknie `okno` (może być obecny).
+SposobBrania wybierzSposob(SposobBrania obecny, const OknoAdaptacji& okno, bool kelnerDozwolony,
+                           bool tryLockDozwolony) {
+    double lekkie = OCZEKIWANIE_LEKKIE * (obecny == SposobBrania::TRY_LOCK ? 1.0 : HISTEREZA);
+    double ciezkie = OCZEKIWANIE_CIEZKIE * (obecny == SposobBrania::KELNER ? HISTEREZA : 1.0);
+    if (kelnerDozwolony && okno.oczekiwanie > ciezkie) return SposobBrania::KELNER;
+    bool tryLockDrogi = obecny == SposobBrania::TRY_LOCK && tryLockZaDrogi(okno);
+    if (okno.oczekiwanie < lekkie && tryLockDozwolony && !tryLockDrogi) return SposobBrania::TRY_LOCK;
+    return SposobBrania::PORZADEK;
+}
+
+/*
+ * Wartość okna lub przełączenia, która może nie istnieć (ujemna - np. brak głodów
+ * w TRY_LOCK albo brak pomiaru "po"): wg `format` albo `brak` ("-" w tekście, null w JSON).
+ */
+string wartoscLubBrak(double wartosc, const char* format, const char* brak = "-") {
+    if (wartosc < 0) return brak;
+    char tekst[32];
+    snprintf(tekst, sizeof(tekst), format, wartosc);
+    return tekst;
+}
+
+void wypiszPrzelaczenie(const PrzelaczenieAdaptacji& p) {
+    fprintf(stderr, "Adaptacja %.2f s: %s -> %s (oczekiwanie %.2f, porazki try_lock %s, procesor %.2f,"
+            " %.1f posilkow/s)\n", p.chwilaS, nazwaSposobu(p.z), nazwaSposobu(p.na), p.przed.oczekiwanie,
+            wartoscLubBrak(p.przed.porazek, "%.2f").c_str(), p.przed.procesor, p.przed.posilkiNaS);
+}
+
+void petlaKontrolera() {
+    int n = liczbaFilozofow;
+    int rdzeni = (int)max(1u, thread::hardware_concurrency());
+    bool kelnerDozwolony = topologia.jestPierscieniem();
+    // Sumy liczników na początku bieżącego okna.
+    auto sumuj = [n](long long& posilki, long long& glodow, long long& kolizji) {
+        posilki = glodow = kolizji = 0;
+        for (int i = 0; i < n; ++i) {
+            posilki += odczytajLicznikPosilkow(i);
+            glodow += licznikiAdaptacji[i].glodowTryLock.load(memory_order_relaxed);
+            kolizji += licznikiAdaptacji[i].kolizji.load(memory_order_relaxed);
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    auto poczatekOkna = start;
+    auto poczatekSposobu = start;
+    long long posilki0, glodow0, kolizji0;
+    sumuj(posilki0, glodow0, kolizji0);
+    // Głodni zliczani co obrót od początku okna.
+    long long glodnych = 0;
+    long long odczytow = 0;
+    double procesor0 = czasProcesoraS();
+    SposobBrania kandydat = sposobBrania.load();
+    int potwierdzen = 0;
+    int okienWSposobie = 0;
+    bool czekaNaPrzejscie = false; // Ktoś jeszcze bierze pałeczki starym sposobem
+    bool mierzPo = false;          // Następne pełne okno to tempo "po"
+    int karaTryLock = 0;           // Ile okien po porzuceniu TRY_LOCK nie wracamy do niego
+    int okienBezTryLock = 0;
+
+    while (symulacjaDziala) {
+        // Krótkie drzemki, żeby szybko zauważyć koniec symulacji i koniec przejścia.
+        this_thread::sleep_for(chrono::milliseconds(min(kontroler.okresMs, 10)));
+        auto teraz = chrono::steady_clock::now();
+        SposobBrania obecny = sposobBrania.load();
+        if (czekaNaPrzejscie) {
+            bool wszyscy = true;
+            for (int i = 0; i < n && wszyscy; ++i) {
+                wszyscy = licznikiAdaptacji[i].sposob.load(memory_order_relaxed) == obecny;
+            }
+            if (wszyscy) {
+                lock_guard<mutex> blokada(kontroler.blokada);
+                PrzelaczenieAdaptacji& p = kontroler.przelaczenia.back();
+                p.przejscieMs = chrono::duration<double, milli>(teraz - start).count() - p.chwilaS * 1e3;
+                czekaNaPrzejscie = false;
+                mierzPo = true;
+                // Okno "po" zaczyna się dopiero teraz - liczniki od nowa.
+                poczatekOkna = teraz;
+                sumuj(posilki0, glodow0, kolizji0);
+                procesor0 = czasProcesoraS();
+                glodnych = odczytow = 0;
+            }
+        }
+        for (int i = 0; i < n; ++i) glodnych += odczytajStanFilozofa(i) == StanFilozofa::GLODNY;
+        odczytow++;
+        double dlugoscS = chrono::duration<double>(teraz - poczatekOkna).count();
+        if (dlugoscS * 1e3 < kontroler.okresMs) continue;
+        long long posilki, glodow, kolizji;
+        sumuj(posilki, glodow, kolizji);
+        if (posilki - posilki0 < MIN_POSILKOW_OKNA) continue;
+
+        OknoAdaptacji okno;
+        double procesor = czasProcesoraS();
+        okno.dlugoscS = dlugoscS;
+        okno.posilki = posilki - posilki0;
+        okno.posilkiNaS = okno.posilki / dlugoscS;
+        okno.oczekiwanie = (double)glodnych / ((double)odczytow * n);
+        okno.porazek = glodow > glodow0 ? (double)(kolizji - kolizji0) / (glodow - glodow0) : -1.0;
+        okno.procesor = (procesor - procesor0) / (dlugoscS * rdzeni);
+        poczatekOkna = teraz;
+        posilki0 = posilki;
+        glodow0 = glodow;
+        kolizji0 = kolizji;
+        glodnych = odczytow = 0;
+        procesor0 = procesor;
+
+        lock_guard<mutex> blokada(kontroler.blokada);
+        kontroler.ostatnie = okno;
+        kontroler.okien++;
+        okienWSposobie++;
+        okienBezTryLock++;
+        if (mierzPo) {
+            PrzelaczenieAdaptacji& p = kontroler.przelaczenia.back();
+            p.posilkiNaSPo = okno.posilkiNaS;
+            mierzPo = false;
+            if (kontroler.naBiezaco) {
+                fprintf(stderr, "Adaptacja %.2f s: %s po przejsciu (%.0f ms): %.1f posilkow/s, przed %.1f\n",
+                        chrono::duration<double>(teraz - start).count(), nazwaSposobu(p.na), p.przejscieMs,
+                        p.posilkiNaSPo, p.przed.posilkiNaS);
+            }
+            continue;
+        }
+        SposobBrania cel = wybierzSposob(obecny, okno, kelnerDozwolony, okienBezTryLock >= karaTryLock);
+        if (cel == obecny || czekaNaPrzejscie || okienWSposobie < MIN_OKIEN_W_SPOSOBIE) {
+            potwierdzen = 0;
+            continue;
+        }
+        potwierdzen = cel == kandydat ? potwierdzen + 1 : 1;
+        kandydat = cel;
+        if (potwierdzen < POTWIERDZEN) continue;
+
+        PrzelaczenieAdaptacji p;
+        p.chwilaS = chrono::duration<double>(teraz - start).count();
+        p.z = obecny;
+        p.na = cel;
+        p.przed = okno;
+        if (obecny == SposobBrania::TRY_LOCK) {
+            // Porzucony, bo za drogi - następnym razem dłuższa przerwa; z innego powodu - kara od nowa.
+            karaTryLock = tryLockZaDrogi(okno) ? min(KARA_TRY_LOCK_MAKS, max(MIN_OKIEN_W_SPOSOBIE, 2 * karaTryLock)) : 0;
+            okienBezTryLock = 0;
+        }
+        kontroler.czasWSposobieS[(int)obecny] += chrono::duration<double>(teraz - poczatekSposobu).count();
+        poczatekSposobu = teraz;
+        sposobBrania.store(cel, memory_order_release);
+        kontroler.przelaczenia.push_back(p);
+        if (kontroler.naBiezaco) wypiszPrzelaczenie(p);
+        potwierdzen = 0;
+        okienWSposobie = 0;
+        czekaNaPrzejscie = true;
+    }
+    lock_guard<mutex> blokada(kontroler.blokada);
+    kontroler.czasWSposobieS[(int)sposobBrania.load()] +=
+        chrono::duration<double>(chrono::steady_clock::now() - poczatekSposobu).count();
+    kontroler.cpuS = czasProcesoraWatkuS();
+}
+
+// Zeruje liczniki, ustawia sposób początkowy i startuje kontroler (przed wątkami filozofów).
+void uruchomKontroler(int okresMs, bool naBiezaco) {
+    licznikiAdaptacji = vector<LicznikiAdaptacji>(liczbaFilozofow);
+    sposobBrania.store(SposobBrania::PORZADEK);
+    kontroler.okresMs = okresMs;
+    kontroler.naBiezaco = naBiezaco;
+    kontroler.watek = thread(petlaKontrolera);
+}
+
+void zatrzymajKontroler() {
+    if (kontroler.watek.joinable()) kontroler.watek.join();
+}
+
+
+//TRYB ZADAŃ (filozofowie na puli pracowników)
+
+
+/*
+ * Filozof jako maszyna stanów: planista woła krokFilozofa(), a ten wykonuje tyle,
+ * ile się da bez czekania, i mówi, kiedy obudzić go ponownie. Myślenie i jedzenie
+ * to budziki w kole czasowym planisty, a zajęta pałeczka to "spróbuj później".
+ */
+enum class FazaZadania { NOWE, MYSLI, GLODNY, JE };
+
+struct alignas(ROZMIAR_LINII) ZadanieFilozofa {
+    FazaZadania faza = FazaZadania::NOWE;
+    int wziete = 0;   // Ile pałeczek z kolejnoscDla() już trzyma
+    int porazki = 0;  // Nieudane try_lock w tym głodzie (strategia 2)
+    int proba = 0;    // Kolejne odczekanie wykładnicze w tym głodzie (--ponawianie)
+};
+vector<ZadanieFilozofa> zadaniaFilozofow;
+int wyborLogikiZadan = 0;
+
+// Oddaje pierwsze `ile` pałeczek z kolejności filozofa, od ostatniej wziętej.
+template <typename Blokada>
+void oddajPaleczkiZadania(int id, int ile) {
+    span<const int> kolejnosc = kolejnoscDla(id);
+    for (int j = ile - 1; j >= 0; --j) {
+        ustawWlascicielaPaleczki(kolejnosc[j], -1);
+        paleczkiStolu<Blokada>[kolejnosc[j]].unlock();
+    }
+}
+
+/*
+ * Ponowienie po porażce zadania strategii 2 wg --ponawianie. Brak, pauza i yield
+ * wykonujemy na pracowniku jak w wątkach; odczekania wykładniczego nie możemy przespać
+ * na pracowniku (stanęłyby jego pozostałe zadania), więc staje się budzikiem w kole
+ * czasowym planisty - krótsze od ODCZEKANIE_SEN_OD_US to po prostu kolejna runda.
+ */
+WynikKroku ponowienieZadania(ZadanieFilozofa& zadanie, chrono::steady_clock::time_point teraz) {
+    if (politykaPonawiania != PolitykaPonawiania::WYKLADNICZA && politykaPonawiania != PolitykaPonawiania::STARZENIE) {
+        odczekajPoPorazce(zadanie.proba);
+        return { true, teraz };
+    }
+    int czekajUs = losujOdczekanieUs(zadanie.proba);
+    if (czekajUs < ODCZEKANIE_SEN_OD_US) return { true, teraz };
+    return { false, teraz + chrono::microseconds(czekajUs) };
+}
+
+/*
+ * Jeden krok filozofa-zadania. Pałeczki są brane tylko przez try_lock(), w kolejności
+ * kolejnoscDla() (ta sama co w wątkowych wersjach strategii 1-4), a już wzięte zostają
+ * u zadania między krokami (jak przy lock() w wersji wątkowej), z wyjątkiem strategii 2,
+ * która po porażce odkłada wszystkie i ponawia wg --ponawianie. Zadanie może wrócić
+ * na innym pracowniku, dlatego blokada pałeczki musi dać się zwolnić z dowolnego wątku.
+ */
+template <typename Blokada>
+WynikKroku krokFilozofa(int id, chrono::steady_clock::time_point teraz) {
+    vector<Paleczka<Blokada>>& paleczki = paleczkiStolu<Blokada>;
+    ZadanieFilozofa& zadanie = zadaniaFilozofow[id];
+    switch (zadanie.faza) {
+        case FazaZadania::JE:
+            // Koniec jedzenia - oddanie pałeczek.
+            oddajPaleczkiZadania<Blokada>(id, zadanie.wziete);
+            zadanie.wziete = 0;
+            [[fallthrough]];
+        case FazaZadania::NOWE: {
+            int ms = zacznijMyslenie(id);
+            zadanie.faza = FazaZadania::MYSLI;
+            return { false, teraz + chrono::milliseconds(ms) };
+        }
+        case FazaZadania::MYSLI:
+            ustawStanFilozofa(id, StanFilozofa::GLODNY);
+            zadanie.faza = FazaZadania::GLODNY;
+            [[fallthrough]];
+        case FazaZadania::GLODNY: {
+            span<const int> kolejnosc = kolejnoscDla(id);
+            // W polityce STARZENIE ustępujemy głodnemu sąsiadowi, który zjadł mniej od nas.
+            if (wyborLogikiZadan == 2 && politykaPonawiania == PolitykaPonawiania::STARZENIE
+                && sasiadMaPierwszenstwo(id)) {
+                return ponowienieZadania(zadanie, teraz);
+            }
+            while (zadanie.wziete < (int)kolejnosc.size()) {
+                int paleczka = kolejnosc[zadanie.wziete];
+                if (!paleczki[paleczka].try_lock()) {
+                    zadanie.porazki++;
+                    if (wyborLogikiZadan == 2) {
+                        oddajPaleczkiZadania<Blokada>(id, zadanie.wziete);
+                        zadanie.wziete = 0;
+                        return ponowienieZadania(zadanie, teraz);
+                    }
+                    return { true, teraz };
+                }
+                ustawWlascicielaPaleczki(paleczka, id);
+                zadanie.wziete++;
+            }
+            if (wyborLogikiZadan == 2) zapiszNieudaneProby(id, zadanie.porazki);
+            zadanie.porazki = 0;
+            zadanie.proba = 0;
+            int ms = zacznijJedzenie(id);
+            zadanie.faza = FazaZadania::JE;
+            return { false, teraz + chrono::milliseconds(ms) };
+        }
+    }
+    return { false, teraz };
+}
+
+PlanistaZadan::FunkcjaKroku krokFilozofaDla(RodzajBlokady rodzaj) {
+    switch (rodzaj) {
+        case RodzajBlokady::BILETOWA: return krokFilozofa<BlokadaBiletowa>;
+        case RodzajBlokady::MCS:      return krokFilozofa<BlokadaMCS>;
+        case RodzajBlokady::FUTEX:    return krokFilozofa<BlokadaFutex>;
+        case RodzajBlokady::MUTEX:    break; // std::mutex musi zwolnić ten sam wątek - nie nadaje się
+    }
+    return nullptr;
+}
+
+// Strategie, które mają wersję zadaniową (kelner i Chandy-Misra czekają na innych wątkach).
+bool strategiaJakoZadanie(int wyborLogiki) {
+    return wyborLogiki >= 1 && wyborLogiki <= 4;
+}
+
+/*
+ * Zakleszczenie w trybie zadań i korutyn, sprawdzane po zatrzymaniu wykonawców (stan
+ * już się nie zmienia): głodny filozof, który trzyma początek swojej kolejności, czeka
+ * na właściciela następnej pałeczki. Z każdego filozofa wychodzi najwyżej jedna taka
+ * krawędź, więc cykl znajdujemy, idąc po krawędziach (jak strażnik, tylko bez wyścigów).
+ * Na pierścieniu cykl to cały stół - każdy z jedną pałeczką w ręku.
+ */
+bool cyklOczekiwania() {
+    int n = liczbaFilozofow;
+    vector<int> czekaNa(n, -1);
+    for (int i = 0; i < n; ++i) {
+        if (odczytajStanFilozofa(i) != StanFilozofa::GLODNY) continue;
+        span<const int> kolejnosc = kolejnoscDla(i);
+        size_t wziete = 0;
+        while (wziete < kolejnosc.size() && odczytajWlascicielaPaleczki(kolejnosc[wziete]) == i) wziete++;
+        if (wziete == 0 || wziete == kolejnosc.size()) continue;
+        czekaNa[i] = odczytajWlascicielaPaleczki(kolejnosc[wziete]);
+    }
+    // 0 - nieodwiedzony, 1 - na bieżącej ścieżce, 2 - sprawdzony.
+    vector<char> kolor(n, 0);
+    for (int s = 0; s < n; ++s) {
+        int v = s;
+        while (v >= 0 && kolor[v] == 0) {
+            kolor[v] = 1;
+            v = czekaNa[v];
+        }
+        if (v >= 0 && kolor[v] == 1) return true;
+        for (v = s; v >= 0 && kolor[v] == 1; v = czekaNa[v]) kolor[v] = 2;
+    }
+    return false;
+}
+
+//TRYB KORUTYN (filozofowie na pętli zdarzeń)
+
+
+/*
+ * Strategia 2 po porażce odkłada pałeczkę i próbuje ponownie po czasie rosnącym
+ * wykładniczo (czasu pętli) - stałe odpytywanie w czasie wirtualnym to setki
+ * tysięcy pustych wznowień na każdy posiłek sąsiada.
+ */
+const chrono::microseconds PONOWIENIE_KORUTYNY_MIN(100);
+const chrono::microseconds PONOWIENIE_KORUTYNY_MAKS(100000);
+
+// Pętla z czasem wirtualnym - z niej czyta zegarSymulacji w benchmarku korutyn.
+PetlaZdarzen* petlaKorutyn = nullptr;
+
+/*
+ * Filozof jako korutyna. Kolejność pałeczek jak w trybie zadań. Strategie 1, 3 i 4
+ * czekają na pałeczkę w kolejce BlokadaAsync (odpowiednik lock()), strategia 2 bierze
+ * wszystkie przez try_lock() i po porażce odkłada wzięte. Między pałeczkami korutyna
+ * oddaje kolejkę - w wątkach tu może nastąpić przełączenie i bez tego naiwna
+ * strategia nigdy by się nie zakleszczyła.
+ * Korutyna nigdy się nie kończy - ramkę niszczy Wykonawcy po zatrzymaniu pętli.
+ */
+Korutyna filozofKorutyna(PetlaZdarzen& petla, int id, int wyborLogiki) {
+    span<const int> kolejnosc = kolejnoscDla(id);
+    int k = (int)kolejnosc.size();
+    while (true) {
+        co_await petla.spij(chrono::milliseconds(zacznijMyslenie(id)));
+        ustawStanFilozofa(id, StanFilozofa::GLODNY);
+        if (wyborLogiki == 2) {
+            chrono::microseconds odczekanie = PONOWIENIE_KORUTYNY_MIN;
+            int porazki = 0;
+            while (true) {
+                int wziete = 0;
+                while (wziete < k && paleczkiKorutyn[kolejnosc[wziete]].blokada.try_lock()) {
+                    wziete++;
+                    if (wziete < k) co_await petla.spij(chrono::microseconds(0));
+                }
+                if (wziete == k) break;
+                while (wziete > 0) paleczkiKorutyn[kolejnosc[--wziete]].blokada.unlock(petla);
+                porazki++;
+                co_await petla.spij(odczekanie);
+                odczekanie = min(odczekanie * 2, PONOWIENIE_KORUTYNY_MAKS);
+            }
+            zapiszNieudaneProby(id, porazki);
+            for (int paleczka : kolejnosc) ustawWlascicielaPaleczki(paleczka, id);
+        } else {
+            for (int j = 0; j < k; ++j) {
+                co_await paleczkiKorutyn[kolejnosc[j]].blokada.zablokuj();
+                ustawWlascicielaPaleczki(kolejnosc[j], id);
+                if (j + 1 < k) co_await petla.spij(chrono::microseconds(0));
+            }
+        }
+        co_await petla.spij(chrono::milliseconds(zacznijJedzenie(id)));
+        for (int j = k - 1; j >= 0; --j) {
+            ustawWlascicielaPaleczki(kolejnosc[j], -1);
+            paleczkiKorutyn[kolejnosc[j]].blokada.unlock(petla);
+        }
+    }
+}
+
+
+/*
+ * Wątki albo planista zadań, na których działają filozofowie (opcja --wykonanie).
+ */
+struct Wykonawcy {
+    vector<thread> watki;
+    unique_ptr<PlanistaZadan> planista;
+    unique_ptr<PetlaZdarzen> petla;
+    vector<Korutyna> korutyny;
+    // Licznik wątków, które wyszły z pętli życia - pozwala wykryć zakleszczenie przy końcu.
+    atomic<int> zakonczoneWatki{0};
+};
+
+void uruchomFilozofow(Wykonawcy& wykonawcy, int wyborLogiki, const KonfiguracjaSymulacji& konfig) {
+    int n = liczbaFilozofow;
+    przygotujKolejnosc(wyborLogiki);
+    if (konfig.wykonanie == Wykonanie::KORUTYNY) {
+        /*
+         * W benchmarku czas jest wirtualny, a pętlę kręci sam uruchomBenchmark().
+         * W podglądzie ncurses pętla działa w czasie rzeczywistym na własnym wątku.
+         */
+        bool wirtualny = konfig.benchmark;
+        wykonawcy.petla.reset(new PetlaZdarzen(wirtualny));
+        PetlaZdarzen* petla = wykonawcy.petla.get();
+        if (wirtualny) {
+            petlaKorutyn = petla;
+            zegarSymulacji = [] { return petlaKorutyn->teraz(); };
+            if (slad.wlaczony()) {
+                slad.ustawZegar([] { return (uint64_t)petlaKorutyn->teraz().time_since_epoch().count(); });
+            }
+        }
+        wykonawcy.korutyny.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            wykonawcy.korutyny.push_back(filozofKorutyna(*petla, i, wyborLogiki));
+            petla->zaplanuj(wykonawcy.korutyny.back().start());
+        }
+        if (!wirtualny) {
+            wykonawcy.watki.emplace_back([petla, &wykonawcy] {
+                petla->uruchom(symulacjaDziala, chrono::steady_clock::time_point::max());
+                wykonawcy.zakonczoneWatki++;
+            });
+        }
+        return;
+    }
+    if (konfig.wykonanie == Wykonanie::ZADANIA) {
+        wyborLogikiZadan = wyborLogiki;
+        zadaniaFilozofow = vector<ZadanieFilozofa>(n);
+        int pracownicy = konfig.liczbaPracownikow;
+        if (pracownicy == 0) pracownicy = max(1u, thread::hardware_concurrency());
+        wykonawcy.planista.reset(new PlanistaZadan(pracownicy, n, krokFilozofaDla(konfig.rodzajBlokady)));
+        wykonawcy.planista->uruchom(symulacjaDziala);
+        return;
+    }
+    if (konfig.straznikMs > 0) uruchomStraznika(konfig.straznikMs, konfig.odzyskiwanie);
+    if (konfig.przypinanie) przygotujPrzypiecie(konfig.przypiecie);
+    if (wyborLogiki == 7) uruchomKontroler(konfig.okresAdaptacjiMs, konfig.benchmark);
+    FunkcjaFilozofa logika = logikaFilozofa(wyborLogiki, konfig.rodzajBlokady);
+    wykonawcy.watki.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        // Wybierz funkcję logiki na podstawie wyboru użytkownika
+        wykonawcy.watki.emplace_back([logika, i, &wykonawcy] {
+            if (!procesoryFilozofow.empty() && !TopologiaProcesorow::przypnijWatek(procesoryFilozofow[i])) {
+                nieudanychPrzypiec++;
+            }
+            logika(i);
+            wykonawcy.zakonczoneWatki++;
+        });
+    }
+}
+
+/*
+ * Po symulacjaDziala = false czeka na filozofów najwyżej `limit`. Zwraca false,
+ * jeśli któryś wątek nie wrócił (stoi na lock() - zakleszczenie); wtedy wątków
+ * nie dołączamy. Pracownicy planisty nigdy nie blokują, więc zawsze wracają;
+ * pętla korutyn też (zakleszczone korutyny tylko przestają dostawać zdarzenia).
+ */
+bool zakonczFilozofow(Wykonawcy& wykonawcy, chrono::milliseconds limit) {
+    zatrzymajStraznika();
+    zatrzymajEksporter();
+    zatrzymajKontroler();
+    if (wykonawcy.planista) {
+        wykonawcy.planista->dolacz();
+        return true;
+    }
+    int n = (int)wykonawcy.watki.size();
+    auto koniec = chrono::steady_clock::now() + limit;
+    while (wykonawcy.zakonczoneWatki.load() < n && chrono::steady_clock::now() < koniec) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    if (wykonawcy.zakonczoneWatki.load() < n) return false;
+    for (auto& watek : wykonawcy.watki) {
+        watek.join();
+    }
+    return true;
+}
+
+
+//ŚLAD ZDARZEŃ - eksport
+
+
+/*
+ * Włącza ślad przed startem filozofów. Budżet zdarzeń dzielimy na wątki, które będą
+ * pisać: wątek na filozofa, pracownicy planisty albo jeden wątek pętli korutyn.
+ */
+void wlaczSlad(const KonfiguracjaSymulacji& konfig) {
+    size_t piszacych = 1;
+    if (konfig.wykonanie == Wykonanie::WATKI) piszacych = konfig.liczbaFilozofow;
+    if (konfig.wykonanie == Wykonanie::ZADANIA) {
+        piszacych = konfig.liczbaPracownikow > 0 ? konfig.liczbaPracownikow
+                                                 : max(1u, thread::hardware_concurrency());
+    }
+    slad.wlacz(max(MIN_ZDARZEN_NA_WATEK, LIMIT_ZDARZEN_SLADU / piszacych));
+}
+
+// Jeden przedział czasu ("complete event") w formacie Chrome trace.
+void wypiszPrzedzial(FILE* plik, bool& pierwszy, const char* nazwa, int proces, int watek,
+                     uint64_t odNs, uint64_t doNs) {
+    fprintf(plik, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            pierwszy ? "" : ",", nazwa, proces, watek, odNs / 1000.0, (doNs - odNs) / 1000.0);
+    pierwszy = false;
+}
+
+/*
+ * Zapisuje ślad jako JSON Chrome trace (otwiera go chrome://tracing i ui.perfetto.dev).
+ * Proces 1 to filozofowie (wiersz na filozofa, przedziały MYSLI / GLODNY / JE),
+ * proces 2 to pałeczki (wiersz na pałeczkę, przedział = kto ją trzyma).
+ * Przedziały otwarte na końcu śladu zamykamy ostatnim zdarzeniem.
+ * Zwraca liczbę zdarzeń albo -1, gdy pliku nie da się utworzyć.
+ */
+long long zapiszSlad(const string& sciezka, uint64_t& utracone) {
+    vector<ZdarzenieSladu> zdarzenia = slad.zbierz(utracone);
+    FILE* plik = fopen(sciezka.c_str(), "w");
+    if (!plik) return -1;
+    int n = liczbaFilozofow;
+    fprintf(plik, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool pierwszy = true;
+    fprintf(plik, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Filozofowie\"}}");
+    fprintf(plik, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"Paleczki\"}}");
+    pierwszy = false;
+
+    int paleczek = liczbaPaleczek;
+    vector<int> stan(n, -1);
+    vector<uint64_t> odStanu(n, 0);
+    vector<int> trzyma(paleczek, -1);
+    vector<uint64_t> odTrzymania(paleczek, 0);
+    vector<char> nazwany(n, 0);
+    char nazwa[32];
+    for (const ZdarzenieSladu& z : zdarzenia) {
+        if (z.kto < 0 || z.kto >= n) continue;
+        if (!nazwany[z.kto]) {
+            fprintf(plik, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    z.kto, imionaFilozofow[z.kto].c_str());
+            nazwany[z.kto] = 1;
+        }
+        switch ((ZdarzenieFilozofa)z.rodzaj) {
+            case ZdarzenieFilozofa::STAN:
+                if (stan[z.kto] >= 0) {
+                    wypiszPrzedzial(plik, pierwszy, stanNaString((StanFilozofa)stan[z.kto]), 1, z.kto,
+                                    odStanu[z.kto], z.czas);
+                }
+                stan[z.kto] = (int)z.argument;
+                odStanu[z.kto] = z.czas;
+                break;
+            case ZdarzenieFilozofa::BIERZE:
+                if ((int)z.argument < paleczek) {
+                    trzyma[z.argument] = z.kto;
+                    odTrzymania[z.argument] = z.czas;
+                }
+                break;
+            case ZdarzenieFilozofa::ODDAJE:
+                // Oddanie bez wzięcia - wzięcie wypadło z bufora cyklicznego.
+                if ((int)z.argument < paleczek && trzyma[z.argument] >= 0) {
+                    snprintf(nazwa, sizeof(nazwa), "%d", trzyma[z.argument]);
+                    wypiszPrzedzial(plik, pierwszy, nazwa, 2, (int)z.argument, odTrzymania[z.argument], z.czas);
+                    trzyma[z.argument] = -1;
+                }
+                break;
+        }
+    }
+    uint64_t koniec = max(slad.nsOdStartu(), zdarzenia.empty() ? (uint64_t)0 : zdarzenia.back().czas);
+    for (int i = 0; i < n; ++i) {
+        if (stan[i] >= 0) {
+            wypiszPrzedzial(plik, pierwszy, stanNaString((StanFilozofa)stan[i]), 1, i, odStanu[i], koniec);
+        }
+    }
+    for (int i = 0; i < paleczek; ++i) {
+        if (trzyma[i] >= 0) {
+            snprintf(nazwa, sizeof(nazwa), "%d", trzyma[i]);
+            wypiszPrzedzial(plik, pierwszy, nazwa, 2, i, odTrzymania[i], koniec);
+        }
+    }
+    fprintf(plik, "\n]}\n");
+    fclose(plik);
+    return (long long)zdarzenia.size();
+}
+
+
+//TRYB BENCHMARK - pomiar
 
-    /*
-     * Pętla życia filozofa.
-     */
-    while (symulacjaDziala) {
 
-         //Myślenie.
+// Czas procesora zużyty przez cały proces (użytkownik + jądro), w sekundach.
+double czasProcesoraS() {
+    rusage zuzycie{};
+    getrusage(RUSAGE_SELF, &zuzycie);
+    return zuzycie.ru_utime.tv_sec + zuzycie.ru_utime.tv_usec / 1e6
+         + zuzycie.ru_stime.tv_sec + zuzycie.ru_stime.tv_usec / 1e6;
+}
 
-        mysl(id);
+// Najwyższa pamięć rezydentna procesu od startu, w kB.
+long maksymalnaPamiecKb() {
+    rusage zuzycie{};
+    getrusage(RUSAGE_SELF, &zuzycie);
+    return zuzycie.ru_maxrss;
+}
 
+// Pamięć rezydentna procesu (RSS) w bajtach - z /proc/self/statm, 0 gdy niedostępna.
+long long pamiecRezydentnaB() {
+    long long strony = 0, rezydentne = 0;
+    FILE* plik = fopen("/proc/self/statm", "r");
+    if (!plik) return 0;
+    if (fscanf(plik, "%lld %lld", &strony, &rezydentne) != 2) rezydentne = 0;
+    fclose(plik);
+    return rezydentne * sysconf(_SC_PAGESIZE);
+}
 
-         //Jest głodny.
+// Rozkład wartości w JSON: percentyle i maksimum podzielone przez `jednostka` (np. ns -> us).
+void wypiszRozklad(const char* nazwa, const Rozklad& rozklad, double jednostka) {
+    printf(",\"%s\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f,\"pomiarow\":%llu}",
+           nazwa, rozklad.percentyl(0.50) / jednostka, rozklad.percentyl(0.90) / jednostka,
+           rozklad.percentyl(0.99) / jednostka, rozklad.percentyl(0.999) / jednostka,
+           rozklad.maksimum() / jednostka, (unsigned long long)rozklad.liczbaPomiarow());
+}
 
-        ustawStanFilozofa(id, StanFilozofa::GLODNY);
+/*
+ * Tryb benchmark: uruchamia filozofów bez ncurses na zadany czas i wypisuje
+ * jedną linię JSON z przepustowością, sprawiedliwością i czasami oczekiwania.
+ */
+int uruchomBenchmark(const KonfiguracjaSymulacji& konfig) {
+    int n = konfig.liczbaFilozofow;
+    long long pamiecPrzedB = pamiecRezydentnaB();
+    przygotujStol(n, konfig.rodzajBlokady, konfig.wykonanie);
+    ustawCzasyTrybu(konfig.wyborLogiki);
+    zastosujKonfiguracje(konfig);
+
+    if (!konfig.plikSladu.empty()) wlaczSlad(konfig);
+    if (!konfig.plikMetryk.empty() && !uruchomEksporter(konfig.plikMetryk, konfig.okresMetrykMs)) {
+        cerr << "Nie udalo sie otworzyc pliku metryk " << konfig.plikMetryk << endl;
+        return 1;
+    }
+    Wykonawcy wykonawcy;
+    uruchomFilozofow(wykonawcy, konfig.wyborLogiki, konfig);
+    // Ile pamięci kosztuje filozof: stół, wątki / zadania / ramki korutyn.
+    long long pamiecNaFilozofaB = (pamiecRezydentnaB() - pamiecPrzedB) / n;
 
-        /*
-         * Podnoszenie pałeczek ZGODNIE Z HIERARCHIĄ.
-         * Zawsze blokujemy najpierw mutex pałeczki o niższym ID.
-         * Funkcja lock() jest blokująca - wątek czeka, jeśli pałeczka jest zajęta.
-         */
-        paleczki[pierwsza_paleczka_id].lock();
-        ustawWlascicielaPaleczki(pierwsza_paleczka_id, id);
+    /*
+     * Pomiar liczymy od momentu, gdy wszystkie wątki już wystartowały
+     * (przy dziesiątkach tysięcy filozofów samo tworzenie wątków trwa zauważalnie).
+     * Korutyny w benchmarku żyją w czasie wirtualnym: `--czas` to czas symulowany,
+     * a pętla kręci się tu, na wątku głównym, najwyżej tyle samo czasu rzeczywistego.
+     * Z podanym ziarnem limitu rzeczywistego nie ma - wynik ma zależeć tylko od ziarna.
+     */
+    vector<int> posilkiNaStart(n);
+    for (int i = 0; i < n; ++i) posilkiNaStart[i] = odczytajLicznikPosilkow(i);
+    auto start = zegarSymulacji();
+    auto startRzeczywisty = chrono::steady_clock::now();
+    double procesorStart = czasProcesoraS();
+    auto czasTrwania = chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(konfig.czasTrwaniaS));
+    PetlaZdarzen::Koniec koniecPetli = PetlaZdarzen::Koniec::LIMIT_CZASU;
+    if (wykonawcy.petla) {
+        auto limitRzeczywisty = konfig.ziarno >= 0 ? chrono::steady_clock::time_point::max()
+                                                   : startRzeczywisty + czasTrwania;
+        koniecPetli = wykonawcy.petla->uruchom(symulacjaDziala, start + czasTrwania, limitRzeczywisty);
+    } else if (konfig.fazyS > 0) {
+        // Zmienne obciążenie: fazy lekka i ciężka na zmianę, zaczynając od lekkiej.
+        auto koniecPomiaru = startRzeczywisty + czasTrwania;
+        auto okresFazy = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(konfig.fazyS));
+        for (auto zmiana = startRzeczywisty + okresFazy; zmiana < koniecPomiaru; zmiana += okresFazy) {
+            this_thread::sleep_until(zmiana);
+            fazaCiezka.store(!fazaCiezka.load());
+        }
+        this_thread::sleep_until(koniecPomiaru);
+    } else {
+        this_thread::sleep_for(czasTrwania);
+    }
+    vector<int> posilkiNaKoniec(n);
+    for (int i = 0; i < n; ++i) posilkiNaKoniec[i] = odczytajLicznikPosilkow(i);
+    auto koniec = zegarSymulacji();
+    double czasRzeczywistyS = chrono::duration<double>(chrono::steady_clock::now() - startRzeczywisty).count();
+    // Ile procesora spalili filozofowie w oknie pomiaru (np. kręcąc się na blokadach).
+    double procesorS = czasProcesoraS() - procesorStart;
+    symulacjaDziala = false;
 
-        /*Podniesienie drugiej pałeczki (o wyższym ID).
-         * Wątek wciąż trzyma pierwszą pałeczkę.
-         */
-        paleczki[druga_paleczka_id].lock();
-        ustawWlascicielaPaleczki(druga_paleczka_id, id);
+    /*
+     * Czekamy na wątki najwyżej tyle, ile trwa jeden pełny cykl myślenia i jedzenia
+     * (plus zapas). Jeśli któryś nie wrócił, stoi na lock() - to zakleszczenie.
+     * W trybie zadań nikt nie stoi, zakleszczenie to cykl oczekiwania w zatrzymanym stanie,
+     * a w trybie korutyn - także pętla, której skończyły się zdarzenia.
+     */
+    bool zakleszczenie = !zakonczFilozofow(wykonawcy,
+        chrono::milliseconds(CZAS_MYSLENIA_MAX_MS + CZAS_JEDZENIA_MAX_MS + 1000));
+    if (konfig.wykonanie == Wykonanie::ZADANIA) zakleszczenie = cyklOczekiwania();
+    if (konfig.wykonanie == Wykonanie::KORUTYNY) {
+        zakleszczenie = koniecPetli == PetlaZdarzen::Koniec::BRAK_ZDARZEN || cyklOczekiwania();
+    }
 
-        /*Jedzenie.
-         * Filozof ma obie pałeczki.
-         */
-        jedz(id);
+    double czasS = chrono::duration<double>(koniec - start).count();
+    // Same zerowe czasy: zegar wirtualny stoi w miejscu, więc zostaje czas rzeczywisty.
+    if (czasS <= 0.0) czasS = czasRzeczywistyS;
+    long long posilki = 0;
+    int minPosilkow = numeric_limits<int>::max();
+    int maxPosilkow = 0;
+    for (int i = 0; i < n; ++i) {
+        int p = posilkiNaKoniec[i] - posilkiNaStart[i];
+        posilki += p;
+        minPosilkow = min(minPosilkow, p);
+        maxPosilkow = max(maxPosilkow, p);
+    }
+    double srednia = (double)posilki / n;
+    double wariancja = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double d = (posilkiNaKoniec[i] - posilkiNaStart[i]) - srednia;
+        wariancja += d * d;
+    }
+    double odchylenie = sqrt(wariancja / n);
+
+    // Suma kontrolna liczników posiłków (FNV-1a) - do porównywania przebiegów z tym samym ziarnem.
+    uint64_t sumaKontrolna = 14695981039346656037ull;
+    for (int i = 0; i < n; ++i) {
+        uint32_t p = (uint32_t)(posilkiNaKoniec[i] - posilkiNaStart[i]);
+        for (int bajt = 0; bajt < 4; ++bajt) {
+            sumaKontrolna ^= (p >> (8 * bajt)) & 0xff;
+            sumaKontrolna *= 1099511628211ull;
+        }
+    }
+
+    // Histogramy scalamy dopiero, gdy wątki skończyły (zakleszczone i tak nic nie zapisują).
+    Rozklad oczekiwanie = scalHistogramy(histogramyOczekiwania);
+
+    // Ślad zapisujemy, gdy nikt już nie pisze (zakleszczone wątki też stoją).
+    long long zdarzenSladu = 0;
+    uint64_t utraconychSladu = 0;
+    if (slad.wlaczony()) zdarzenSladu = zapiszSlad(konfig.plikSladu, utraconychSladu);
+
+    printf("{\"strategia\":\"%s\",\"blokada\":\"%s\",\"ponawianie\":\"%s\",\"filozofow\":%d,\"czas_s\":%.3f,"
+           "\"myslenie_ms\":[%d,%d],\"jedzenie_ms\":[%d,%d],"
+           "\"posilki\":%lld,\"posilki_na_s\":%.1f,\"cpu_s\":%.3f,\"cpu_us_na_posilek\":%.3f,"
+           "\"sprawiedliwosc\":{\"min\":%d,\"max\":%d,\"srednia\":%.2f,\"odch_std\":%.2f},"
+           "\"zakleszczenie\":%s",
+           nazwaStrategii(konfig.wyborLogiki),
+           konfig.wykonanie == Wykonanie::KORUTYNY ? "async" : nazwaBlokady(konfig.rodzajBlokady),
+           nazwaPonawiania(konfig.politykaPonawiania), n, czasS,
+           CZAS_MYSLENIA_MIN_MS, CZAS_MYSLENIA_MAX_MS, CZAS_JEDZENIA_MIN_MS, CZAS_JEDZENIA_MAX_MS,
+           posilki, posilki / czasS, procesorS, posilki > 0 ? procesorS * 1e6 / posilki : 0.0,
+           minPosilkow, maxPosilkow, srednia, odchylenie,
+           zakleszczenie ? "true" : "false");
+    wypiszRozklad("oczekiwanie_us", oczekiwanie, 1000.0);
+    wypiszRozklad("trzymanie_paleczki_us", scalHistogramy(histogramyTrzymania), 1000.0);
+    if (strategiaZTryLock(konfig.wyborLogiki)) wypiszRozklad("nieudane_try_lock_na_posilek", scalHistogramy(histogramyPorazek), 1.0);
+    printf(",\"wykonanie\":\"%s\",\"pamiec_na_filozofa_B\":%lld,\"rss_maks_kb\":%ld",
+           nazwaWykonania(konfig.wykonanie), pamiecNaFilozofaB, maksymalnaPamiecKb());
+    printf(",\"topologia\":\"%s\",\"paleczek\":%d,\"paleczek_na_filozofa_maks\":%d",
+           topologia.nazwa().c_str(), liczbaPaleczek, topologia.maksZasobowAgenta());
+    printf(",\"logika\":\"%s\"", nazwaLogiki(konfig.wyborLogiki, konfig.wykonanie));
+    if (konfig.fazyS > 0) printf(",\"fazy_s\":%.3f", konfig.fazyS);
+    printf(",\"ziarno\":%lld,\"suma_kontrolna\":\"%016llx\"", konfig.ziarno,
+           (unsigned long long)sumaKontrolna);
+    if (wykonawcy.petla) {
+        printf(",\"czas_rzeczywisty_s\":%.3f,\"posilki_na_s_rzeczywiste\":%.1f,\"ramka_korutyny_B\":%lld,"
+               "\"wznowien\":%lld",
+               czasRzeczywistyS, posilki / czasRzeczywistyS, Korutyna::bajtyRamek() / n,
+               wykonawcy.petla->liczbaWznowien());
+    }
+    if (wykonawcy.planista) {
+        printf(",\"pracownicy\":%d,\"kradziezy\":%lld", wykonawcy.planista->liczbaPracownikow(),
+               wykonawcy.planista->liczbaKradziezy());
+    }
+    if (straznik.okresMs > 0) {
+        long long cykli = straznik.cykli.load();
+        printf(",\"straznik\":{\"okres_ms\":%d,\"przegladow\":%lld,\"cykli\":%lld,\"przerwanych\":%lld,"
+               "\"wykrycie_ms\":{\"srednie\":%.3f,\"max\":%.3f},\"pierwsze_wykrycie_s\":%.3f,"
+               "\"cpu_ms\":%.3f,\"ns_na_posilek\":%.1f}",
+               straznik.okresMs, straznik.przegladow.load(), cykli, straznik.przerwanych.load(),
+               cykli > 0 ? straznik.sumaWykryciaNs.load() / 1e6 / cykli : 0.0, straznik.maksWykryciaNs.load() / 1e6,
+               cykli > 0 ? straznik.pierwszeWykrycieNs.load() / 1e9 : -1.0, straznik.cpuS * 1e3,
+               posilki > 0 ? straznik.cpuS * 1e9 / posilki : 0.0);
+    }
+    if (konfig.przypinanie) {
+        OcenaRozmieszczenia ocena = ocenRozmieszczenie();
+        int nieudanych = nieudanychPrzypiec.load();
+        printf(",\"przypiecie\":{\"tryb\":\"%s\",\"procesorow\":%d,\"gniazd\":%d,\"domen_l3\":%d,\"domen_l2\":%d,"
+               "\"nieudanych_przypiec\":%d",
+               nazwaPrzypiecia(konfig.przypiecie), topologiaProcesorow.liczbaProcesorow(),
+               topologiaProcesorow.liczbaGniazd(), topologiaProcesorow.liczbaDomenL3(),
+               topologiaProcesorow.liczbaDomenL2(), nieudanych);
+        if (nieudanych > 0) {
+            fprintf(stderr, "Nie udalo sie przypiac %d watkow - rozmieszczenie %s nie jest zachowane\n", nieudanych,
+                    nazwaPrzypiecia(konfig.przypiecie));
+        }
+        // Ułamki par filozofów dzielących pałeczkę - tylko, gdy wiadomo, gdzie kto naprawdę siedzi.
+        if (ocena.par > 0 && nieudanych == 0) {
+            printf(",\"par_sasiadow\":%lld,\"ten_sam_procesor\":%.3f,\"wspolne_l2\":%.3f,\"wspolne_l3\":%.3f,"
+                   "\"to_samo_gniazdo\":%.3f",
+                   ocena.par, (double)ocena.tenSamProcesor / ocena.par, (double)ocena.wspolneL2 / ocena.par,
+                   (double)ocena.wspolneL3 / ocena.par, (double)ocena.toSamoGniazdo / ocena.par);
+        }
+        wypiszRozklad("przekazanie_us", scalHistogramy(histogramyPrzekazania), 1000.0);
+        printf("}");
+    }
+    if (!konfig.plikMetryk.empty()) {
+        printf(",\"metryki\":{\"plik\":\"%s\",\"probek\":%lld,\"bajtow\":%lld,\"zaleglosci\":%lld}",
+               konfig.plikMetryk.c_str(), eksporter.zapis.liczbaProbek(), eksporter.zapis.zapisanychBajtow(),
+               eksporter.zapis.zaleglosci());
+    }
+    if (slad.wlaczony()) {
+        printf(",\"slad\":{\"plik\":\"%s\",\"zdarzen\":%lld,\"nadpisanych\":%llu}",
+               konfig.plikSladu.c_str(), zdarzenSladu, (unsigned long long)utraconychSladu);
+    }
+    if (kontroler.okresMs > 0) {
+        printf(",\"adaptacja\":{\"okres_ms\":%d,\"okien\":%lld,\"sposob_koncowy\":\"%s\",\"cpu_ms\":%.3f,"
+               "\"czas_w_sposobie_s\":{",
+               kontroler.okresMs, kontroler.okien, nazwaSposobu(sposobBrania.load()), kontroler.cpuS * 1e3);
+        for (int i = 0; i < LICZBA_SPOSOBOW; ++i) {
+            printf("%s\"%s\":%.3f", i > 0 ? "," : "", nazwaSposobu((SposobBrania)i), kontroler.czasWSposobieS[i]);
+        }
+        printf("},\"przelaczenia\":[");
+        for (size_t i = 0; i < kontroler.przelaczenia.size(); ++i) {
+            const PrzelaczenieAdaptacji& p = kontroler.przelaczenia[i];
+            printf("%s{\"chwila_s\":%.3f,\"z\":\"%s\",\"na\":\"%s\",\"oczekiwanie\":%.3f,\"porazki_try_lock\":%s,"
+                   "\"procesor\":%.3f,\"posilki_na_s_przed\":%.1f,\"posilki_na_s_po\":%s,\"przejscie_ms\":%s}",
+                   i > 0 ? "," : "", p.chwilaS, nazwaSposobu(p.z), nazwaSposobu(p.na), p.przed.oczekiwanie,
+                   wartoscLubBrak(p.przed.porazek, "%.3f", "null").c_str(), p.przed.procesor, p.przed.posilkiNaS,
+                   wartoscLubBrak(p.posilkiNaSPo, "%.1f", "null").c_str(),
+                   wartoscLubBrak(p.przejscieMs, "%.1f", "null").c_str());
+        }
+        printf("]}");
+    }
+    if (konfig.wyborLogiki == 5) {
+        double partia = 0.0;
+        switch (konfig.rodzajBlokady) {
+            case RodzajBlokady::MUTEX:    partia = sredniaPartiaKelnera<mutex>(); break;
+            case RodzajBlokady::BILETOWA: partia = sredniaPartiaKelnera<BlokadaBiletowa>(); break;
+            case RodzajBlokady::MCS:      partia = sredniaPartiaKelnera<BlokadaMCS>(); break;
+            case RodzajBlokady::FUTEX:    partia = sredniaPartiaKelnera<BlokadaFutex>(); break;
+        }
+        printf(",\"kelner_srednia_partia\":%.2f", partia);
+    }
+    printf("}\n");
+    fflush(stdout);
 
+    if (zakleszczenie) {
         /*
-         *  Odkładanie pałeczek.
+         * Zakleszczonych wątków nie da się dołączyć (join czekałby w nieskończoność),
+         * a niszczenie zablokowanych muteksów to UB - kończymy proces od razu.
          */
-        ustawWlascicielaPaleczki(druga_paleczka_id, -1);
-        paleczki[druga_paleczka_id].unlock();
+        _Exit(2);
+    }
+    return 0;
+}
+
 
-        ustawWlascicielaPaleczki(pierwsza_paleczka_id, -1);
-        paleczki[pierwsza_paleczka_id].unlock();
+//WERYFIKACJA MODELU (opcja --weryfikuj)
 
 
+/*
+ * Model protokołu brania pałeczek do przeszukania wszystkich przeplotów (przestrzen.h).
+ * Filozof i ma k pałeczek (kolejnoscDla - ta sama kolejność, co w symulacji) i fazę:
+ *   0          - myśli,
+ *   1..k       - głodny, trzyma v-1 pierwszych pałeczek i sięga po v-tą,
+ *   k+1        - je (trzyma wszystkie),
+ *   k+2        - skończył: już nigdy nie zgłodnieje.
+ * Właściciel każdej pałeczki wynika z faz (trzyma ją ten, kto ma ją wśród pierwszych
+ * v-1), więc stan to same fazy upakowane w liczbę o podstawach k+3 - pierścień mieści
+ * się w 64 bitach do 27 filozofów. Faza "skończył" sprawia, że każde zakleszczenie,
+ * także częściowe (kilku czeka w kółko, reszta mogłaby jeść dalej), kończy się stanem
+ * bez ruchów, w którym nie wszyscy skończyli - taki stan to błąd. Znaleziony błąd
+ * oznacza, że któryś filozof może czekać w nieskończoność (zagłodzenie przez blokadę).
+ *
+ * Strategie: 1, 3, 4 - lock() po kolei (zajęta pałeczka blokuje), 2 - try_lock()
+ * po kolei, po porażce odkłada wszystkie wzięte, 5 - kelner: wszystkie naraz albo nic.
+ *
+ * Redukcja przeplotów (partial-order reduction): w każdym stanie rozwijamy tylko
+ * zbiór uparty (stubborn set) - zamknięcie ruchów jednego filozofa o:
+ *  - wszystkich użytkowników pałeczki, której dotyka jego możliwy ruch (mogą się z nim
+ *    ścigać albo zmienić jego wynik),
+ *  - właściciela pałeczki, na którą czeka zablokowany (bez jego ruchu nic go nie odblokuje).
+ * Myślenie, kończenie i - przy lock() - oddawanie pałeczek niczego nie dotykają
+ * w cudzych możliwych ruchach, więc nie dokładają nikogo. Spośród zbiorów zaczętych
+ * od każdego filozofa bierzemy ten z najmniejszą liczbą ruchów. Taka redukcja
+ * zachowuje wszystkie osiągalne stany bez ruchów (zakleszczenia).
+ */
+class ModelFilozofow {
+public:
+    // `blad` opisuje, czemu modelu nie da się zbudować (za duży stół, zła strategia).
+    ModelFilozofow(int strategia, string& blad) : strategia(strategia), n(liczbaFilozofow) {
+        if (strategia < 1 || strategia > 5) {
+            blad = "weryfikacja obsluguje strategie 1-5 (Chandy-Misra i adaptacyjna nie maja modelu)";
+            return;
+        }
+        uint64_t waga = 1;
+        for (int i = 0; i < n; ++i) {
+            int k = (int)kolejnoscDla(i).size();
+            uint64_t baza = k + 3;
+            if (waga > UINT64_MAX / baza) {
+                blad = "stan " + to_string(n) + " filozofow nie miesci sie w 64 bitach";
+                return;
+            }
+            ile.push_back(k);
+            bazy.push_back(baza);
+            wagi.push_back(waga);
+            waga *= baza;
+            stanKoncowy += (uint64_t)(k + 2) * wagi[i];
+        }
+        poprawny = true;
     }
-}
 
-int main() {
-    // Menu wyboru logiki
-    int wyborLogiki = 0;
-    cout << "Wybierz logike dzialania filozofow:" << endl;
-    cout << "  1. Zakleszczenie (naiwna)" << endl;
-    cout << "  2. Zaglodzenie (try_lock)" << endl;
-    cout << "  3. Poprawna (asymetryczna)" << endl;
-    cout << "  4. Poprawna (hierarchia zasobow)" << endl;
-    while (true) {
-        cout << "Wybor (1, 2, 3, 4): ";
-        cin >> wyborLogiki;
-        if (wyborLogiki >= 1 && wyborLogiki <= 4) {
-            cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Ignoruj resztę linii, w tym Enter
-            break;
+    bool gotowy() const { return poprawny; }
+    uint64_t poczatkowy() const { return 0; }
+    bool koncowyPoprawny(uint64_t stan) const { return stan == stanKoncowy; }
+
+    void nastepniki(uint64_t stan, vector<uint64_t>& wynik) const {
+        Roboczy& r = roboczy();
+        rozpakuj(stan, r);
+        int najlepszyRuchow = INT_MAX;
+        for (int p = 0; p < n; ++p) {
+            int cele[2];
+            if (ruchy(r, p, cele) == 0) continue;
+            int ruchow = domknij(r, p);
+            if (ruchow < najlepszyRuchow) {
+                najlepszyRuchow = ruchow;
+                r.najlepszy = r.zbior;
+                if (ruchow == 1) break;
+            }
+        }
+        if (najlepszyRuchow == INT_MAX) return;
+        for (int q : r.najlepszy) {
+            int cele[2];
+            int ile = ruchy(r, q, cele);
+            for (int j = 0; j < ile; ++j) wynik.push_back(stan + (uint64_t)(cele[j] - r.faza[q]) * wagi[q]);
         }
-        cout << "Niepoprawny wybor." << endl;
-        // Czyszczenie bufora cin na wypadek błędnego wejścia
-        cin.clear();
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
     }
 
+    // Fazy filozofów w stanie - do opisu kontrprzykładu.
+    vector<int> fazy(uint64_t stan) const {
+        vector<int> wynik(n);
+        for (int i = 0; i < n; ++i) {
+            wynik[i] = (int)(stan % bazy[i]);
+            stan /= bazy[i];
+        }
+        return wynik;
+    }
 
-    // Inicjalizacja biblioteki ncurses
-    if (initscr() == NULL) {
-        // Jeśli inicjalizacja się nie powiodła, wypisz błąd i zakończ
-        fprintf(stderr, "Blad podczas inicjalizacji ncurses.\n");
-        return 1;
+    int paleczek(int i) const { return ile[i]; }
+
+private:
+    // Bufory jednego wątku przeszukiwania - bez alokacji na każdy stan.
+    struct Roboczy {
+        vector<int> faza;
+        vector<int> wlasciciel;
+        vector<int> zbior;
+        vector<int> najlepszy;
+        vector<char> wZbiorze;
+    };
+
+    Roboczy& roboczy() const {
+        thread_local Roboczy r;
+        r.faza.resize(n);
+        r.wZbiorze.assign(n, 0);
+        r.wlasciciel.assign(liczbaPaleczek, -1);
+        return r;
     }
-    noecho();               // Nie wyświetlaj wciskanych klawiszy
-    cbreak();               // Reaguj na klawisze natychmiast (bez buforowania linii)
-    nodelay(stdscr, TRUE);  // Funkcja getch() nie będzie czekać na klawisz (tryb nieblokujący)
-    curs_set(0);            // Ukryj kursor terminala
 
-    // Inicjalizacja stanów początkowych filozofów i pałeczek oraz liczników
-    for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
-        stanyFilozofow[i] = StanFilozofa::MYSLI; // Wszyscy zaczynają myśleć
-        wlascicielePaleczek[i] = -1; // Wszystkie pałeczki są wolne
-        licznikPosilkow[i].store(0); // Wyzeruj atomowe liczniki
+    // Ile pałeczek trzyma filozof w fazie `v`.
+    int trzymane(int i, int v) const {
+        if (v >= 1 && v <= ile[i]) return v - 1;
+        return v == ile[i] + 1 ? ile[i] : 0;
     }
 
-    // Ustawienie zakresów czasu w zależności od wybranego trybu
-    switch (wyborLogiki) {
-        case 1:
-            cout << "Tryb 1 (Zakleszczenie)" << endl;
-            CZAS_MYSLENIA_MIN_MS = 2000;
-            CZAS_MYSLENIA_MAX_MS = 2000;
-            CZAS_JEDZENIA_MIN_MS = 2000;
-            CZAS_JEDZENIA_MAX_MS = 5000;
-            break;
+    void rozpakuj(uint64_t stan, Roboczy& r) const {
+        for (int i = 0; i < n; ++i) {
+            r.faza[i] = (int)(stan % bazy[i]);
+            stan /= bazy[i];
+            span<const int> kolejnosc = kolejnoscDla(i);
+            for (int j = 0; j < trzymane(i, r.faza[i]); ++j) r.wlasciciel[kolejnosc[j]] = i;
+        }
+    }
 
-        case 2:
-            cout << "Tryb 2 (Zaglodzenie)" << endl;
-            CZAS_JEDZENIA_MIN_MS = 1000;
-            CZAS_JEDZENIA_MAX_MS = 4000;
-            CZAS_MYSLENIA_MIN_MS = 2000;
-            CZAS_MYSLENIA_MAX_MS = 5000;
-            break;
+    // Możliwe ruchy filozofa `i` - nowe fazy w `cele`, zwraca ich liczbę (0 = zablokowany).
+    int ruchy(const Roboczy& r, int i, int* cele) const {
+        int v = r.faza[i];
+        int k = ile[i];
+        if (v == 0) {
+            cele[0] = 1;
+            cele[1] = k + 2;
+            return 2;
+        }
+        if (v == k + 1) {
+            cele[0] = 0;
+            return 1;
+        }
+        if (v == k + 2) return 0;
+        span<const int> kolejnosc = kolejnoscDla(i);
+        if (strategia == 5) {
+            for (int c : kolejnosc) {
+                if (r.wlasciciel[c] >= 0) return 0;
+            }
+            cele[0] = k + 1;
+            return 1;
+        }
+        if (r.wlasciciel[kolejnosc[v - 1]] < 0) {
+            cele[0] = v + 1;
+            return 1;
+        }
+        // try_lock się nie udał: odkłada wzięte (bez wziętych nic się nie zmienia - to nie ruch).
+        if (strategia == 2 && v > 1) {
+            cele[0] = 1;
+            return 1;
+        }
+        return 0;
+    }
 
-        case 3:
-            cout << "Tryb 3 (Poprawny)" << endl;
-            CZAS_JEDZENIA_MIN_MS = 1000;
-            CZAS_JEDZENIA_MAX_MS = 4000;
-            CZAS_MYSLENIA_MIN_MS = 2000;
-            CZAS_MYSLENIA_MAX_MS = 5000;
-            break;
-        case 4: //
-            cout << "Tryb 4 (Poprawny - Hierarchia)" << endl;
-            CZAS_JEDZENIA_MIN_MS = 1000;
-            CZAS_JEDZENIA_MAX_MS = 4000;
-            CZAS_MYSLENIA_MIN_MS = 2000;
-            CZAS_MYSLENIA_MAX_MS = 5000;
-            break;
+    void dodaj(Roboczy& r, int q) const {
+        if (r.wZbiorze[q]) return;
+        r.wZbiorze[q] = 1;
+        r.zbior.push_back(q);
     }
 
-    // Uruchamianie 5 wątków filozofów
-    thread watkiFilozofow[LICZBA_FILOZOFOW];
+    void dodajUzytkownikow(Roboczy& r, int paleczka) const {
+        for (int u : topologia.uzytkownicy(paleczka)) dodaj(r, u);
+    }
 
-    for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
-        // Wybierz funkcję logiki na podstawie wyboru użytkownika
-        switch (wyborLogiki) {
-            case 1: watkiFilozofow[i] = thread(Zakleszczenie_Filozofowie, i); break;
-            case 2: watkiFilozofow[i] = thread(Zaglodzenie_Filozofowie, i); break;
-            case 3: watkiFilozofow[i] = thread(Asymetria_Filozofowie, i); break;
-            case 4: watkiFilozofow[i] = thread(Hierarchia_Filozofowie, i); break;
+    // Zbiór uparty zaczęty od filozofa `p` (w r.zbior) - zwraca liczbę jego ruchów.
+    int domknij(Roboczy& r, int p) const {
+        for (int q : r.zbior) r.wZbiorze[q] = 0;
+        r.zbior.clear();
+        dodaj(r, p);
+        int ruchow = 0;
+        for (size_t i = 0; i < r.zbior.size(); ++i) {
+            int q = r.zbior[i];
+            int cele[2];
+            int mozliwych = ruchy(r, q, cele);
+            ruchow += mozliwych;
+            int v = r.faza[q];
+            int k = ile[q];
+            if (v == 0 || v == k + 2) continue;
+            span<const int> kolejnosc = kolejnoscDla(q);
+            if (v == k + 1) {
+                // Oddanie zmienia wynik cudzego try_lock(); cudzy lock() na trzymanej pałeczce i tak stoi.
+                if (strategia == 2) {
+                    for (int c : kolejnosc) dodajUzytkownikow(r, c);
+                }
+                continue;
+            }
+            if (strategia == 5) {
+                if (mozliwych > 0) {
+                    for (int c : kolejnosc) dodajUzytkownikow(r, c);
+                } else {
+                    for (int c : kolejnosc) {
+                        if (r.wlasciciel[c] >= 0) {
+                            dodaj(r, r.wlasciciel[c]);
+                            break;
+                        }
+                    }
+                }
+                continue;
+            }
+            int c = kolejnosc[v - 1];
+            if (mozliwych == 0) {
+                dodaj(r, r.wlasciciel[c]);
+                continue;
+            }
+            dodajUzytkownikow(r, c);
+            // Nieudany try_lock odkłada też wzięte - dotyka wszystkich trzymanych pałeczek.
+            if (strategia == 2 && r.wlasciciel[c] >= 0) {
+                for (int j = 0; j < v - 1; ++j) dodajUzytkownikow(r, kolejnosc[j]);
+            }
         }
+        return ruchow;
     }
 
-    /* Główna pętla programu (rysowanie stanu i obsługa wejścia w main)
-     * Zmienne lokalne do przechowywania kopii stanu
-     * Pętla działa dopóki użytkownik nie naciśnie 'q'
-     */
-    vector<StanFilozofa> stany_kopia(LICZBA_FILOZOFOW);
-    vector<int> liczniki_kopia(LICZBA_FILOZOFOW);
-    vector<int> wlasciciele_kopia(LICZBA_FILOZOFOW);
+    int strategia;
+    int n;
+    vector<int> ile;
+    vector<uint64_t> bazy;
+    vector<uint64_t> wagi;
+    uint64_t stanKoncowy = 0;
+    bool poprawny = false;
+};
+
+// Opis ruchu filozofa `i` z fazy `z` do `na` (k - liczba jego pałeczek).
+string opiszRuch(int strategia, int i, int z, int na, int k) {
+    span<const int> kolejnosc = kolejnoscDla(i);
+    if (z == 0 && na == 1) return "glodnieje";
+    if (z == 0) return "konczy (juz nie zglodnieje)";
+    if (z == k + 1) return "oddaje paleczki i mysli";
+    if (strategia == 5) return "dostaje od kelnera wszystkie paleczki i je";
+    if (na == 1) return "nie dostaje paleczki " + to_string(kolejnosc[z - 1]) + ", odklada wziete";
+    string opis = "bierze paleczke " + to_string(kolejnosc[z - 1]);
+    return na == k + 1 ? opis + " i je" : opis;
+}
 
-    while (symulacjaDziala) {
-        /* Kopiuje aktualny stan globalny do zmiennych lokalnych (pod muteksem) */
-        {
-            lock_guard<mutex> blokada(mutexStanu);
-            for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
-                stany_kopia[i] = stanyFilozofow[i];
-                liczniki_kopia[i] = licznikPosilkow[i].load();
-                wlasciciele_kopia[i] = wlascicielePaleczek[i];
-            }
+/*
+ * Tryb --weryfikuj: przeszukuje wszystkie przeploty modelu strategii na bieżącej
+ * topologii i albo dowodzi braku zakleszczeń, albo wypisuje najkrótszą ścieżkę do
+ * zakleszczenia. Kod wyjścia: 0 - dowód, 2 - zakleszczenie, 1 - wynik niepełny / błąd.
+ */
+int uruchomWeryfikacje(const KonfiguracjaSymulacji& konfig) {
+    liczbaFilozofow = konfig.liczbaFilozofow;
+    liczbaPaleczek = topologia.liczbaZasobow();
+    uzupelnijImiona(liczbaFilozofow);
+    przygotujKolejnosc(konfig.wyborLogiki);
+    string blad;
+    ModelFilozofow model(konfig.wyborLogiki, blad);
+    if (!model.gotowy()) {
+        cerr << "Weryfikacja: " << blad << endl;
+        return 1;
+    }
+    ZbiorStanow zbior((uint64_t)konfig.stanowMaksMln * 1000000);
+    if (!zbior.gotowy()) {
+        cerr << "Weryfikacja: brak pamieci na zbior stanow" << endl;
+        return 1;
+    }
+    int watkow = konfig.liczbaPracownikow > 0 ? konfig.liczbaPracownikow : max(1u, thread::hardware_concurrency());
+    WynikPrzeszukania wynik = przeszukajWszerz(model, zbior, watkow);
+
+    printf("Weryfikacja: strategia %s, topologia %s, %d filozofow, %d paleczek, %d watkow\n",
+           nazwaStrategii(konfig.wyborLogiki), topologia.nazwa().c_str(), liczbaFilozofow, liczbaPaleczek, watkow);
+    printf("Stanow: %llu, przejsc: %llu, glebokosc: %d, czas: %.3f s (%.0f stanow/s), rss maks: %ld MB\n",
+           (unsigned long long)wynik.stanow, (unsigned long long)wynik.przejsc, wynik.glebokosc, wynik.czasS,
+           wynik.stanow / max(wynik.czasS, 1e-9), maksymalnaPamiecKb() / 1024);
+    if (wynik.przepelnienie) {
+        printf("WYNIK NIEPELNY: ponad %llu stanow (zwieksz --stanow-maks)\n", (unsigned long long)zbior.maksimum());
+        return 1;
+    }
+    if (!wynik.znalezionoBlad) {
+        printf("WYNIK: brak zakleszczen - zaden filozof nie moze czekac w nieskonczonosc na paleczke\n");
+        if (konfig.wyborLogiki == 2) printf("(livelock ponawiania try_lock nie jest tu sprawdzany)\n");
+        return 0;
+    }
+
+    // Ścieżka od stanu początkowego do zakleszczenia - po rodzicach, od końca.
+    vector<uint64_t> sciezka = { wynik.stanBledu };
+    while (sciezka.back() != model.poczatkowy()) sciezka.push_back(zbior.rodzic(sciezka.back()));
+    reverse(sciezka.begin(), sciezka.end());
+    printf("WYNIK: ZAKLESZCZENIE osiagalne w %zu krokach:\n", sciezka.size() - 1);
+    for (size_t krok = 1; krok < sciezka.size(); ++krok) {
+        vector<int> przed = model.fazy(sciezka[krok - 1]);
+        vector<int> po = model.fazy(sciezka[krok]);
+        for (int i = 0; i < liczbaFilozofow; ++i) {
+            if (przed[i] == po[i]) continue;
+            printf("  %3zu. %s %s\n", krok, imionaFilozofow[i].c_str(),
+                   opiszRuch(konfig.wyborLogiki, i, przed[i], po[i], model.paleczek(i)).c_str());
         }
+    }
+    // Kto na kogo czeka w stanie końcowym.
+    vector<int> koniec = model.fazy(wynik.stanBledu);
+    vector<int> wlasciciel(liczbaPaleczek, -1);
+    for (int i = 0; i < liczbaFilozofow; ++i) {
+        int k = model.paleczek(i);
+        int trzyma = koniec[i] >= 1 && koniec[i] <= k ? koniec[i] - 1 : 0;
+        for (int j = 0; j < trzyma; ++j) wlasciciel[kolejnoscDla(i)[j]] = i;
+    }
+    printf("Stan koncowy:\n");
+    for (int i = 0; i < liczbaFilozofow; ++i) {
+        int k = model.paleczek(i);
+        if (koniec[i] == k + 2) continue;
+        span<const int> kolejnosc = kolejnoscDla(i);
+        int c = konfig.wyborLogiki == 5 ? -1 : kolejnosc[koniec[i] - 1];
+        if (c < 0) {
+            printf("  %s czeka na kelnera\n", imionaFilozofow[i].c_str());
+        } else {
+            printf("  %s trzyma %d z %d paleczek, czeka na paleczke %d (trzyma ja %s)\n", imionaFilozofow[i].c_str(),
+                   koniec[i] - 1, k, c, imionaFilozofow[wlasciciel[c]].c_str());
+        }
+    }
+    return 2;
+}
+
+
+//PODGLĄD NCURSES
 
-        /* Rysuje stan na ekranie ncurses */
-        erase(); /* Wyczyść bufor ekranu ncurses */
-        mvprintw(0, 0, "-----------------PROBLEM UCZTUJACYCH FILOZOFOW ------------------");
-        mvprintw(2, 0, "ID"); mvprintw(2, 5, "Filozof"); mvprintw(2, 18, "Stan");
-        mvprintw(2, 28, "L. Paleczka"); mvprintw(2, 44, "P. Paleczka"); mvprintw(2, 60, "Zjadl");
 
-        for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
-            int y = 4 + i;
-            mvprintw(y, 0, "%d", i);
-            mvprintw(y, 5, "%s", imionaFilozofow[i].c_str());
-            mvprintw(y, 18, "%s", stanNaString(stany_kopia[i]).c_str());
+/*
+ * Ekran podglądu rysowany na różnicach. Klatkę składamy w zwykłej tablicy znaków
+ * (snprintf do bufora na stosie - bez alokacji), porównujemy z poprzednią i do
+ * ncurses wysyłamy tylko zmienione odcinki wierszy, bez erase() i pełnego przerysowania.
+ */
+struct EkranPodgladu {
+    int wiersze = 0;
+    int kolumny = 0;
+    vector<char> klatka;      // Składana klatka (wiersze * kolumny)
+    vector<char> poprzednia;  // To, co już jest na ekranie
+    long long zmienionych = 0; // Znaków wysłanych w ostatniej klatce
+
+    // Nowa klatka. Po zmianie rozmiaru terminala zaczynamy od pustego ekranu.
+    void zacznij(int noweWiersze, int noweKolumny) {
+        if (noweWiersze != wiersze || noweKolumny != kolumny) {
+            wiersze = noweWiersze;
+            kolumny = noweKolumny;
+            klatka.assign((size_t)wiersze * kolumny, ' ');
+            poprzednia.assign((size_t)wiersze * kolumny, '\0'); // Nic nie pasuje - narysuje się wszystko
+            clearok(stdscr, TRUE);
+        }
+        fill(klatka.begin(), klatka.end(), ' ');
+    }
 
-            stringstream ss_lewa, ss_prawa;
-            int lewa_id = i;
-            if (wlasciciele_kopia[lewa_id] == -1) ss_lewa << "WOLNA";
-            else if (wlasciciele_kopia[lewa_id] == i) ss_lewa << "Trzyma";
-            else ss_lewa << "Zajeta(" << wlasciciele_kopia[lewa_id] << ")";
-            mvprintw(y, 28, "%s", ss_lewa.str().c_str());
+    // printf od komórki (y, x); to, co wystaje poza ekran, jest obcinane.
+    [[gnu::format(printf, 4, 5)]] void pisz(int y, int x, const char* format, ...) {
+        if (y < 0 || y >= wiersze || x >= kolumny) return;
+        char bufor[512];
+        va_list argumenty;
+        va_start(argumenty, format);
+        int dlugosc = vsnprintf(bufor, sizeof(bufor), format, argumenty);
+        va_end(argumenty);
+        dlugosc = min({ dlugosc, (int)sizeof(bufor) - 1, kolumny - x });
+        if (dlugosc > 0) memcpy(&klatka[(size_t)y * kolumny + x], bufor, dlugosc);
+    }
 
-            int prawa_id = (i + 1) % LICZBA_FILOZOFOW;
-            if (wlasciciele_kopia[prawa_id] == -1) ss_prawa << "WOLNA";
-            else if (wlasciciele_kopia[prawa_id] == i) ss_prawa << "Trzyma";
-            else ss_prawa << "Zajeta(" << wlasciciele_kopia[prawa_id] << ")";
-            mvprintw(y, 44, "%s", ss_prawa.str().c_str());
+    void znak(int y, int x, char c) {
+        if (y >= 0 && y < wiersze && x >= 0 && x < kolumny) klatka[(size_t)y * kolumny + x] = c;
+    }
 
-            mvprintw(y, 60, "%d", liczniki_kopia[i]);
+    // Wysyła do ncurses zmienione odcinki (bliskie zmiany łączymy w jeden odcinek).
+    void narysuj() {
+        const int PRZERWA = 4;
+        zmienionych = 0;
+        for (int y = 0; y < wiersze; ++y) {
+            const char* nowy = &klatka[(size_t)y * kolumny];
+            const char* stary = &poprzednia[(size_t)y * kolumny];
+            int x = 0;
+            while (x < kolumny) {
+                if (nowy[x] == stary[x]) {
+                    ++x;
+                    continue;
+                }
+                int koniec = x + 1;
+                for (int zgodnych = 0; koniec < kolumny && zgodnych < PRZERWA; ++koniec) {
+                    zgodnych = nowy[koniec] == stary[koniec] ? zgodnych + 1 : 0;
+                }
+                // Ostatni znak w prawym dolnym rogu przesunąłby kursor poza ekran.
+                int dlugosc = koniec - x;
+                if (y == wiersze - 1 && koniec == kolumny) dlugosc--;
+                if (dlugosc > 0) mvaddnstr(y, x, nowy + x, dlugosc);
+                zmienionych += dlugosc;
+                x = koniec;
+            }
         }
-        mvprintw(LINES - 1, 0, "Nacisnij 'q' aby zakonczyc...");
+        klatka.swap(poprzednia);
+    }
+};
+
+enum class WidokPodgladu { TABELA, MAPA };
+// Co pokazuje mapa ciepła: odsetek głodnych, odsetek jedzących albo niedojadanie bloku.
+enum class MiaraMapy { GLODNI, JEDZACY, NIEDOJADANIE };
+const int LICZBA_MIAR_MAPY = 3;
+// Skala mapy ciepła - od 0% (spacja) do 100% (@).
+const char SKALA_MAPY[] = " .:-=+*#%@";
+
+struct StanPodgladu {
+    WidokPodgladu widok = WidokPodgladu::TABELA;
+    MiaraMapy miara = MiaraMapy::GLODNI;
+    int pierwszy = 0;          // Pierwszy widoczny filozof w tabeli
+    long long klatek = 0;
+    double kosztKlatkiUs = 0.0;
+    double sredniKosztUs = 0.0;
+    // Podsumowanie całego stołu - scalanie wszystkich histogramów liczymy raz na sekundę.
+    char razemCzekanie[64] = "-";
+    char razemTrzymanie[64] = "-";
+};
+
+// Pierwszy wiersz tabeli / mapy i ile wierszy zostaje na dane (reszta to nagłówek i stopka).
+const int GORA_PODGLADU = 4;
+const int STOPKA_PODGLADU = 5;
+
+int wierszeDanych() {
+    return max(1, LINES - GORA_PODGLADU - STOPKA_PODGLADU);
+}
 
-        /* Sprawdzam klawiaturę */
-        int ch = getch();
+const char* nazwaMiary(MiaraMapy miara) {
+    switch (miara) {
+        case MiaraMapy::GLODNI:       return "glodni";
+        case MiaraMapy::JEDZACY:      return "jedzacy";
+        case MiaraMapy::NIEDOJADANIE: return "niedojadanie (mniej posilkow niz srednia stolu)";
+    }
+    return "?";
+}
+
+void opiszPaleczke(char* bufor, size_t rozmiar, int wlasciciel, int id) {
+    if (wlasciciel == -1) snprintf(bufor, rozmiar, "WOLNA");
+    else if (wlasciciel == id) snprintf(bufor, rozmiar, "Trzyma");
+    else snprintf(bufor, rozmiar, "Zajeta(%d)", wlasciciel);
+}
+
+/*
+ * Tabela - tylko widoczne wiersze. Odczyty są atomowe, więc rysowanie nie blokuje
+ * filozofów (ekran może pokazać stan sprzed ułamka mikrosekundy - do podglądu wystarczy).
+ */
+void rysujTabele(EkranPodgladu& ekran, const StanPodgladu& podglad, int n, int wyborLogiki, Rozklad& rozklad) {
+    char tekst[64];
+    bool pierscien = topologia.jestPierscieniem();
+    ekran.pisz(2, 0, "ID"); ekran.pisz(2, 5, "Filozof"); ekran.pisz(2, 18, "Stan");
+    if (pierscien) {
+        ekran.pisz(2, 28, "L. Paleczka"); ekran.pisz(2, 44, "P. Paleczka");
+    } else {
+        ekran.pisz(2, 28, "Ma paleczek"); ekran.pisz(2, 44, "Czeka na");
+    }
+    ekran.pisz(2, 60, "Zjadl");
+    ekran.pisz(2, 68, "Czeka p50/p99/p999/max"); ekran.pisz(2, 101, pierscien ? "L. trzym. p99/max" : "Pal.ID p99/max");
+    if (strategiaZTryLock(wyborLogiki)) ekran.pisz(2, 120, "Porazki p99/max");
+
+    int koniec = min(n, podglad.pierwszy + wierszeDanych());
+    for (int i = podglad.pierwszy; i < koniec; ++i) {
+        int y = GORA_PODGLADU + i - podglad.pierwszy;
+        ekran.pisz(y, 0, "%d", i);
+        ekran.pisz(y, 5, "%s", imionaFilozofow[i].c_str());
+        StanFilozofa stan = odczytajStanFilozofa(i);
+        ekran.pisz(y, 18, "%s", stanNaString(stan));
+        if (pierscien) {
+            opiszPaleczke(tekst, sizeof(tekst), odczytajWlascicielaPaleczki(i), i);
+            ekran.pisz(y, 28, "%s", tekst);
+            opiszPaleczke(tekst, sizeof(tekst), odczytajWlascicielaPaleczki((i + 1) % n), i);
+            ekran.pisz(y, 44, "%s", tekst);
+        } else {
+            // Ile pałeczek z listy już trzyma i na którą (pierwszą brakującą) czeka.
+            span<const int> kolejnosc = kolejnoscDla(i);
+            int ma = 0;
+            int brakujaca = -1;
+            for (int paleczka : kolejnosc) {
+                if (odczytajWlascicielaPaleczki(paleczka) == i) ma++;
+                else if (brakujaca < 0) brakujaca = paleczka;
+            }
+            ekran.pisz(y, 28, "%d/%d", ma, (int)kolejnosc.size());
+            if (stan == StanFilozofa::GLODNY && brakujaca >= 0) {
+                int wlasciciel = odczytajWlascicielaPaleczki(brakujaca);
+                if (wlasciciel < 0) ekran.pisz(y, 44, "#%d wolna", brakujaca);
+                else ekran.pisz(y, 44, "#%d u %d", brakujaca, wlasciciel);
+            }
+        }
+        ekran.pisz(y, 60, "%d", odczytajLicznikPosilkow(i));
+
+        rozklad.wyczysc();
+        rozklad.dodaj(histogramDla(histogramyOczekiwania, i));
+        formatujRozklad(tekst, sizeof(tekst), rozklad, true, true);
+        ekran.pisz(y, 68, "%s", tekst);
+        if (i < liczbaPaleczek) {
+            rozklad.wyczysc();
+            rozklad.dodaj(histogramDla(histogramyTrzymania, i));
+            formatujRozklad(tekst, sizeof(tekst), rozklad, true, false);
+            ekran.pisz(y, 101, "%s", tekst);
+        }
+        if (strategiaZTryLock(wyborLogiki)) {
+            rozklad.wyczysc();
+            rozklad.dodaj(histogramDla(histogramyPorazek, i));
+            formatujRozklad(tekst, sizeof(tekst), rozklad, false, false);
+            ekran.pisz(y, 120, "%s", tekst);
+        }
+    }
+}
+
+/*
+ * Mapa ciepła dla dużych stołów: każda komórka obszaru danych to blok kolejnych
+ * filozofów, a znak ze SKALA_MAPY mówi, jaka część bloku spełnia wybraną miarę.
+ */
+void rysujMape(EkranPodgladu& ekran, const StanPodgladu& podglad, int n) {
+    int komorek = wierszeDanych() * ekran.kolumny;
+    int blok = max(1, (n + komorek - 1) / komorek);
+    ekran.pisz(2, 0, "Mapa ciepla - %s: komorka = %d filozof(ow), skala '%s' = 0..100%%",
+               nazwaMiary(podglad.miara), blok, SKALA_MAPY);
+
+    double sredniaPosilkow = 0.0;
+    if (podglad.miara == MiaraMapy::NIEDOJADANIE) {
+        long long suma = 0;
+        for (int i = 0; i < n; ++i) suma += odczytajLicznikPosilkow(i);
+        sredniaPosilkow = (double)suma / n;
+    }
+    const int STOPNIE = (int)sizeof(SKALA_MAPY) - 2;
+    for (int k = 0; k * blok < n && k < komorek; ++k) {
+        int od = k * blok;
+        int doFilozofa = min(n, od + blok);
+        double wartosc = 0.0;
+        if (podglad.miara == MiaraMapy::NIEDOJADANIE) {
+            long long suma = 0;
+            for (int i = od; i < doFilozofa; ++i) suma += odczytajLicznikPosilkow(i);
+            double sredniaBloku = (double)suma / (doFilozofa - od);
+            wartosc = sredniaPosilkow > 0.0 ? 1.0 - sredniaBloku / sredniaPosilkow : 0.0;
+        } else {
+            StanFilozofa szukany = podglad.miara == MiaraMapy::GLODNI ? StanFilozofa::GLODNY : StanFilozofa::JE;
+            int ile = 0;
+            for (int i = od; i < doFilozofa; ++i) ile += odczytajStanFilozofa(i) == szukany;
+            wartosc = (double)ile / (doFilozofa - od);
+        }
+        int stopien = (int)(min(1.0, max(0.0, wartosc)) * STOPNIE + 0.5);
+        ekran.znak(GORA_PODGLADU + k / ekran.kolumny, k % ekran.kolumny, SKALA_MAPY[stopien]);
+    }
+}
+
+// Przewijanie i przełączanie widoków. Zwraca false po 'q'.
+bool obsluzKlawisz(int ch, StanPodgladu& podglad, int n) {
+    int strona = wierszeDanych();
+    switch (ch) {
+        case 'q': return false;
+        case 'h':
+            podglad.widok = podglad.widok == WidokPodgladu::TABELA ? WidokPodgladu::MAPA : WidokPodgladu::TABELA;
+            break;
+        case 'm': podglad.miara = (MiaraMapy)(((int)podglad.miara + 1) % LICZBA_MIAR_MAPY); break;
+        case KEY_DOWN: case 'j': podglad.pierwszy++; break;
+        case KEY_UP: case 'k': podglad.pierwszy--; break;
+        case KEY_NPAGE: case ' ': podglad.pierwszy += strona; break;
+        case KEY_PPAGE: case 'b': podglad.pierwszy -= strona; break;
+        case KEY_HOME: case 'g': podglad.pierwszy = 0; break;
+        case KEY_END: case 'G': podglad.pierwszy = n; break;
+    }
+    podglad.pierwszy = max(0, min(podglad.pierwszy, n - strona));
+    return true;
+}
+
+// Składa i rysuje jedną klatkę podglądu, mierząc jej koszt.
+void rysujKlatke(EkranPodgladu& ekran, StanPodgladu& podglad, int n, int wyborLogiki, int ch, Rozklad& rozklad) {
+    auto start = chrono::steady_clock::now();
+    ekran.zacznij(LINES, COLS);
+    ekran.pisz(0, 0, "-----------------PROBLEM UCZTUJACYCH FILOZOFOW ------------------");
+    if (podglad.widok == WidokPodgladu::TABELA) {
+        rysujTabele(ekran, podglad, n, wyborLogiki, rozklad);
+        ekran.pisz(0, 68, "Filozofowie %d-%d z %d", podglad.pierwszy,
+                   min(n, podglad.pierwszy + wierszeDanych()) - 1, n);
+    } else {
+        rysujMape(ekran, podglad, n);
+    }
 
-        // Tymczasowo pokazuje, co odczytał getch() (jeśli nie ERR)
-        if (ch != ERR) {
-            mvprintw(LINES - 2, 0, "Odczytano klawisz: %d ('%c')", ch, ch);
+    // Cały stół (przy dużym stole wiersze pokazują histogramy dzielone z innymi).
+    if (podglad.klatek % 10 == 0) {
+        rozklad.wyczysc();
+        for (const HistogramLog& histogram : histogramyOczekiwania) rozklad.dodaj(histogram);
+        formatujRozklad(podglad.razemCzekanie, sizeof(podglad.razemCzekanie), rozklad, true, true);
+        rozklad.wyczysc();
+        for (const HistogramLog& histogram : histogramyTrzymania) rozklad.dodaj(histogram);
+        formatujRozklad(podglad.razemTrzymanie, sizeof(podglad.razemTrzymanie), rozklad, true, true);
+    }
+    if (kontroler.okresMs > 0) {
+        lock_guard<mutex> blokada(kontroler.blokada);
+        const OknoAdaptacji& okno = kontroler.ostatnie;
+        ekran.pisz(1, 0, "Adaptacja: %s | okno: oczekiwanie %.2f, porazki try_lock %s, procesor %.2f, %.1f posilkow/s"
+                   " | przelaczen %zu", nazwaSposobu(sposobBrania.load()), okno.oczekiwanie,
+                   wartoscLubBrak(okno.porazek, "%.2f").c_str(), okno.procesor, okno.posilkiNaS, kontroler.przelaczenia.size());
+    }
+    ekran.pisz(LINES - 4, 0, "Razem: czekanie %s", podglad.razemCzekanie);
+    ekran.pisz(LINES - 4, 48, "trzymanie paleczki %s", podglad.razemTrzymanie);
+    if (straznik.okresMs > 0) {
+        long long cykli = straznik.cykli.load();
+        if (cykli == 0) {
+            ekran.pisz(LINES - 3, 0, "Straznik: brak zakleszczen (przegladow: %lld)", straznik.przegladow.load());
         } else {
-            // Wyczyść poprzedni komunikat, jeśli nic nie naciśnięto
-            mvprintw(LINES - 2, 0, "Odczytano klawisz: ERR     ");
+            ekran.pisz(LINES - 3, 0, "Straznik: ZAKLESZCZENIE x%lld, ostatnie w %.1f s, cykl %d filozofow, wykryte po %.1f ms"
+                       " (maks %.1f ms)%s", cykli, straznik.ostatnieWykrycieNs.load() / 1e9,
+                       straznik.dlugoscOstatniegoCyklu.load(), straznik.wykryciaOstatniegoNs.load() / 1e6,
+                       straznik.maksWykryciaNs.load() / 1e6, straznik.odzyskiwanie ? " - przerwane" : "");
+        }
+    }
+    // Pokazuje, co odczytał getch()
+    if (ch != ERR) ekran.pisz(LINES - 2, 0, "Odczytano klawisz: %d ('%c')", ch, ch);
+    else ekran.pisz(LINES - 2, 0, "Odczytano klawisz: ERR");
+    ekran.pisz(LINES - 2, 40, "Klatka: %.0f us (srednio %.0f us), zmienionych znakow: %lld",
+               podglad.kosztKlatkiUs, podglad.sredniKosztUs, ekran.zmienionych);
+    ekran.pisz(LINES - 1, 0, "q koniec | strzalki, PgUp/PgDn, Home/End - przewijanie | h mapa ciepla | m miara mapy");
+
+    ekran.narysuj();
+    refresh();
+    podglad.kosztKlatkiUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    podglad.sredniKosztUs = podglad.klatek == 0 ? podglad.kosztKlatkiUs
+                                                : 0.9 * podglad.sredniKosztUs + 0.1 * podglad.kosztKlatkiUs;
+    podglad.klatek++;
+}
+
+
+//TRYB INTERAKTYWNY (ncurses)
+
+
+int uruchomInteraktywnie(const KonfiguracjaSymulacji& konfig) {
+    // Menu wyboru logiki (pomijane, jeśli strategię podano w linii poleceń)
+    int wyborLogiki = konfig.wyborLogiki;
+    if (wyborLogiki == 0) {
+        cout << "Wybierz logike dzialania filozofow:" << endl;
+        cout << "  1. Zakleszczenie (naiwna)" << endl;
+        cout << "  2. Zaglodzenie (try_lock)" << endl;
+        cout << "  3. Poprawna (asymetryczna)" << endl;
+        cout << "  4. Poprawna (hierarchia zasobow)" << endl;
+        cout << "  5. Poprawna (kelner / arbiter)" << endl;
+        cout << "  6. Poprawna (Chandy-Misra, wiadomosci)" << endl;
+        cout << "  7. Poprawna (adaptacyjna: try_lock / hierarchia / kelner)" << endl;
+        while (true) {
+            cout << "Wybor (1-" << LICZBA_STRATEGII << "): ";
+            cin >> wyborLogiki;
+            if (wyborLogiki >= 1 && wyborLogiki <= LICZBA_STRATEGII) {
+                cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Ignoruj resztę linii, w tym Enter
+                break;
+            }
+            cout << "Niepoprawny wybor." << endl;
+            // Czyszczenie bufora cin na wypadek błędnego wejścia
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
         }
+    }
+    if (konfig.wykonanie != Wykonanie::WATKI && !strategiaJakoZadanie(wyborLogiki)) {
+        cerr << "Tryb zadan i korutyn obsluguje tylko strategie 1-4" << endl;
+        return 1;
+    }
+    if (!topologia.jestPierscieniem() && !strategiaNaTopologii(wyborLogiki)) {
+        cerr << "Topologia inna niz pierscien obsluguje tylko strategie 1, 2, 4 i 7" << endl;
+        return 1;
+    }
+    if (konfig.straznikMs > 0 && !strategiaCzekaNaPaleczki(wyborLogiki)) {
+        cerr << "Straznik zakleszczen obsluguje tylko strategie 1, 3, 4 i 7 (pozostale nie czekaja na paleczki)" << endl;
+        return 1;
+    }
+
+
+    // Inicjalizacja biblioteki ncurses
+    if (initscr() == NULL) {
+        // Jeśli inicjalizacja się nie powiodła, wypisz błąd i zakończ
+        fprintf(stderr, "Blad podczas inicjalizacji ncurses.\n");
+        return 1;
+    }
+    noecho();               // Nie wyświetlaj wciskanych klawiszy
+    cbreak();               // Reaguj na klawisze natychmiast (bez buforowania linii)
+    nodelay(stdscr, TRUE);  // Funkcja getch() nie będzie czekać na klawisz (tryb nieblokujący)
+    curs_set(0);            // Ukryj kursor terminala
+    keypad(stdscr, TRUE);   // Strzałki i PgUp/PgDn jako kody KEY_* (przewijanie)
+
+    // Inicjalizacja stanów początkowych filozofów i pałeczek oraz liczników
+    int n = konfig.liczbaFilozofow;
+    przygotujStol(n, konfig.rodzajBlokady, konfig.wykonanie);
+
+    // Ustawienie zakresów czasu w zależności od wybranego trybu
+    ustawCzasyTrybu(wyborLogiki);
+    zastosujKonfiguracje(konfig);
+
+    // Uruchamianie wątków filozofów (albo puli pracowników w trybie zadań)
+    if (!konfig.plikSladu.empty()) wlaczSlad(konfig);
+    if (!konfig.plikMetryk.empty() && !uruchomEksporter(konfig.plikMetryk, konfig.okresMetrykMs)) {
+        endwin();
+        cerr << "Nie udalo sie otworzyc pliku metryk " << konfig.plikMetryk << endl;
+        return 1;
+    }
+    Wykonawcy wykonawcy;
+    uruchomFilozofow(wykonawcy, wyborLogiki, konfig);
+
+    /* Główna pętla programu (rysowanie stanu i obsługa wejścia w main)
+     * Pętla działa dopóki użytkownik nie naciśnie 'q'
+     */
+    EkranPodgladu ekran;
+    StanPodgladu podglad;
+    // Rozkład do percentyli na żywo - jeden obiekt na wszystkie wiersze, bez alokacji w pętli.
+    Rozklad rozklad;
 
-        if (ch == 'q') {
+    while (symulacjaDziala) {
+        /* Sprawdzam klawiaturę */
+        int ch = getch();
+        if (!obsluzKlawisz(ch, podglad, n)) {
             symulacjaDziala = false; /* Ustaw flagę zakończenia */
         }
 
-        //POkazuje wszystko na ekranie Aktualizuj fizyczny ekran terminala
-        refresh();
+        rysujKlatke(ekran, podglad, n, wyborLogiki, ch, rozklad);
 
         /* Czekam przed następnym odświeżeniem */
         napms(100);
@@ -522,9 +3676,7 @@ int main() {
 
 
     /* Czekanie, aż wszystkie wątki filozofów zakończą swoją pracę */
-    for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
-        watkiFilozofow[i].join();
-    }
+    zakonczFilozofow(wykonawcy, chrono::hours(24 * 365));
 
     // Zakończenie pracy z biblioteką ncurses i przywrócenie normalnego terminala
     curs_set(1);            //Pokaż z powrotem kursor
@@ -535,10 +3687,131 @@ int main() {
     // Wyświetlenie podsumowania w standardowej konsoli po zamknięciu już ncurses
     cout << "Symulacja zakonczona." << endl;
     cout << "\n--- OSTATECZNE PODSUMOWANIE POSILKOW ---" << endl;
-    for (int i = 0; i < LICZBA_FILOZOFOW; ++i) {
+    for (int i = 0; i < n; ++i) {
         cout << "  " << setw(10) << left << imionaFilozofow[i]
-             << " (" << i << "): zjadl " << licznikPosilkow[i].load() << " razy." << endl;
+             << " (" << i << "): zjadl " << odczytajLicznikPosilkow(i) << " razy." << endl;
+    }
+    char tekst[64];
+    cout << "\n--- OPOZNIENIA (p50/p99/p999/max) ---" << endl;
+    for (int i = 0; i < n && i < LIMIT_HISTOGRAMOW; ++i) {
+        Rozklad oczekiwanie;
+        oczekiwanie.dodaj(histogramyOczekiwania[i]);
+        cout << "  " << setw(10) << left << imionaFilozofow[i] << " (" << i << "): czekanie ";
+        formatujRozklad(tekst, sizeof(tekst), oczekiwanie, true, true);
+        cout << tekst;
+        if (i < (int)histogramyTrzymania.size()) {
+            Rozklad trzymanie;
+            trzymanie.dodaj(histogramyTrzymania[i]);
+            formatujRozklad(tekst, sizeof(tekst), trzymanie, true, true);
+            cout << ", paleczka " << i << " trzymana " << tekst;
+        }
+        if (strategiaZTryLock(wyborLogiki)) {
+            Rozklad porazki;
+            porazki.dodaj(histogramyPorazek[i]);
+            formatujRozklad(tekst, sizeof(tekst), porazki, false, true);
+            cout << ", nieudane try_lock na posilek " << tekst;
+        }
+        cout << endl;
+    }
+    formatujRozklad(tekst, sizeof(tekst), scalHistogramy(histogramyOczekiwania), true, true);
+    cout << "  Razem: czekanie " << tekst;
+    formatujRozklad(tekst, sizeof(tekst), scalHistogramy(histogramyTrzymania), true, true);
+    cout << ", trzymanie paleczki " << tekst;
+    if (strategiaZTryLock(wyborLogiki)) {
+        formatujRozklad(tekst, sizeof(tekst), scalHistogramy(histogramyPorazek), false, true);
+        cout << ", nieudane try_lock na posilek " << tekst;
+    }
+    cout << endl;
+    if (kontroler.okresMs > 0) {
+        cout << "\n--- ADAPTACJA (przelaczenia sposobu brania paleczek) ---" << endl;
+        for (const PrzelaczenieAdaptacji& p : kontroler.przelaczenia) {
+            printf("  %8.2f s: %-8s -> %-8s oczekiwanie %.2f, porazki try_lock %s, procesor %.2f;"
+                   " posilkow/s przed %.1f, po %s (przejscie %s ms)\n",
+                   p.chwilaS, nazwaSposobu(p.z), nazwaSposobu(p.na), p.przed.oczekiwanie,
+                   wartoscLubBrak(p.przed.porazek, "%.2f").c_str(), p.przed.procesor, p.przed.posilkiNaS,
+                   wartoscLubBrak(p.posilkiNaSPo, "%.1f").c_str(), wartoscLubBrak(p.przejscieMs, "%.0f").c_str());
+        }
+        printf("  Czas w sposobie: try_lock %.1f s, porzadek %.1f s, kelner %.1f s\n",
+               kontroler.czasWSposobieS[0], kontroler.czasWSposobieS[1], kontroler.czasWSposobieS[2]);
+        fflush(stdout);
+    }
+    if (slad.wlaczony()) {
+        uint64_t utracone = 0;
+        long long zdarzen = zapiszSlad(konfig.plikSladu, utracone);
+        if (zdarzen < 0) {
+            cerr << "Nie udalo sie zapisac sladu do " << konfig.plikSladu << endl;
+        } else {
+            cout << "\nSlad: " << zdarzen << " zdarzen (nadpisanych: " << utracone << ") w "
+                 << konfig.plikSladu << endl;
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char** argv) {
+    KonfiguracjaSymulacji konfig;
+    if (!parsujArgumenty(argc, argv, konfig)) {
+        wypiszPomoc(argv[0]);
+        return 1;
+    }
+    if (!zbudujTopologie(konfig)) return 1;
+    if (konfig.wyborLogiki != 0 && !topologia.jestPierscieniem() && !strategiaNaTopologii(konfig.wyborLogiki)) {
+        cerr << "Topologia inna niz pierscien obsluguje tylko strategie 1, 2, 4 i 7" << endl;
+        return 1;
+    }
+    if (konfig.straznikMs > 0 && konfig.wykonanie != Wykonanie::WATKI) {
+        cerr << "Straznik zakleszczen dziala tylko w trybie watkow" << endl;
+        return 1;
+    }
+    if (konfig.straznikMs > 0 && konfig.wyborLogiki != 0 && !strategiaCzekaNaPaleczki(konfig.wyborLogiki)) {
+        cerr << "Straznik zakleszczen obsluguje tylko strategie 1, 3, 4 i 7 (pozostale nie czekaja na paleczki)" << endl;
+        return 1;
+    }
+    if (konfig.przypinanie && konfig.wykonanie != Wykonanie::WATKI) {
+        cerr << "Przypinanie watkow (--przypiecie) dziala tylko w trybie watkow" << endl;
+        return 1;
+    }
+    if (konfig.podanoPonawianie && konfig.wykonanie == Wykonanie::KORUTYNY) {
+        cerr << "--ponawianie dziala tylko dla watkow i zadan (korutyny ponawiaja wykladniczo w czasie petli)" << endl;
+        return 1;
+    }
+    if (konfig.odzyskiwanie && konfig.straznikMs == 0) {
+        cerr << "--odzyskiwanie wymaga --straznik" << endl;
+        return 1;
+    }
+    if (konfig.wykonanie == Wykonanie::ZADANIA && konfig.rodzajBlokady == RodzajBlokady::MUTEX) {
+        // Zadanie może oddać pałeczkę na innym wątku niż ją wzięło - std::mutex na to nie pozwala.
+        konfig.rodzajBlokady = RodzajBlokady::FUTEX;
+        cerr << "Tryb zadan: paleczki mutex zamienione na futex (mutex musi zwolnic ten sam watek)" << endl;
+    }
+    if (konfig.fazyS > 0 && (!konfig.benchmark || konfig.wykonanie == Wykonanie::KORUTYNY)) {
+        cerr << "--fazy dziala tylko w trybie benchmark, bez korutyn" << endl;
+        return 1;
+    }
+    if (konfig.weryfikacja) {
+        if (konfig.wyborLogiki == 0) {
+            cerr << "Weryfikacja wymaga --strategia" << endl;
+            return 1;
+        }
+        return uruchomWeryfikacje(konfig);
+    }
+    if (konfig.benchmark) {
+        if (konfig.wyborLogiki == 0) {
+            cerr << "Tryb benchmark wymaga --strategia" << endl;
+            return 1;
+        }
+        if (konfig.wykonanie != Wykonanie::WATKI && !strategiaJakoZadanie(konfig.wyborLogiki)) {
+            cerr << "Tryb zadan i korutyn obsluguje tylko strategie 1-4" << endl;
+            return 1;
+        }
+        if (konfig.ziarno >= 0 && konfig.wykonanie == Wykonanie::KORUTYNY
+            && konfig.myslenieMaxMs == 0 && konfig.jedzenieMaxMs == 0) {
+            // Przy samych zerowych czasach zegar wirtualny nie rusza - bez limitu rzeczywistego pętla by nie skończyła.
+            cerr << "Powtarzalna symulacja (--ziarno) wymaga niezerowych czasow myslenia lub jedzenia" << endl;
+            return 1;
+        }
+        return uruchomBenchmark(konfig);
+    }
+    return uruchomInteraktywnie(konfig);
+}
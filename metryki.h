@@ -0,0 +1,307 @@
+#pragma once
+
+/*
+ * Szeregi czasowe metryk symulacji: zapis (CSV albo zwarty format binarny)
+ * i odczyt formatu binarnego - wspólny dla symulatora i czytnika (czytnik_metryk.cpp).
+ *
+ * Próbka to chwila, liczby myślących / głodnych / jedzących, liczniki posiłków
+ * wszystkich filozofów i właściciele wszystkich pałeczek (pałeczek może być więcej
+ * lub mniej niż filozofów - zależy od topologii).
+ *
+ * Format binarny (little-endian, tylko dopisywany):
+ *   nagłówek: "FILOMET\0", wersja (u32), liczba filozofów (u32), okres próbkowania w us (u32),
+ *             liczba pałeczek (u32, 0 = tyle co filozofów),
+ *   rekord:   długość reszty rekordu (u32), chwila w ns od startu (u64), myślący, głodni,
+ *             jedzący (3 x u32), potem kolumny:
+ *             - przyrosty liczników posiłków od poprzedniego rekordu (varint, zigzag),
+ *             - właściciel pałeczki i jako varint: 0 = wolna, inaczej zigzag(wlasciciel - i) + 1.
+ * Przyrosty i właściciele to prawie zawsze małe liczby, więc większość pól zajmuje 1 bajt.
+ * Urwany ostatni rekord (np. po zabiciu procesu) czytnik po prostu pomija.
+ *
+ * Zapis jest podwójnie buforowany: próbki trafiają do bufora w pamięci, a pełny bufor
+ * oddajemy wątkowi zapisu i piszemy dalej do drugiego. Gdy dysk nie nadąża, bufor
+ * rośnie zamiast czekać - próbkowanie nigdy nie stoi na I/O.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+const char MAGIA_METRYK[8] = { 'F', 'I', 'L', 'O', 'M', 'E', 'T', '\0' };
+const uint32_t WERSJA_METRYK = 1;
+
+struct NaglowekMetryk {
+    char magia[8];
+    uint32_t wersja;
+    uint32_t filozofow;
+    uint32_t okresUs;
+    uint32_t paleczek;
+};
+static_assert(sizeof(NaglowekMetryk) == 24, "naglowek ma 24 bajty");
+
+// Jedna próbka - `filozofow` liczników posiłków i `paleczek` właścicieli.
+struct ProbkaMetryk {
+    uint64_t czasNs = 0;
+    uint32_t mysli = 0;
+    uint32_t glodni = 0;
+    uint32_t jedza = 0;
+    std::vector<int32_t> posilki;
+    std::vector<int32_t> wlasciciele;
+};
+
+
+inline uint64_t zigzag(int64_t wartosc) {
+    return ((uint64_t)wartosc << 1) ^ (uint64_t)(wartosc >> 63);
+}
+
+inline int64_t odZigzag(uint64_t wartosc) {
+    return (int64_t)(wartosc >> 1) ^ -(int64_t)(wartosc & 1);
+}
+
+inline void dopiszVarint(std::vector<char>& bufor, uint64_t wartosc) {
+    while (wartosc >= 0x80) {
+        bufor.push_back((char)(wartosc | 0x80));
+        wartosc >>= 7;
+    }
+    bufor.push_back((char)wartosc);
+}
+
+// Zwraca false, gdy varint wychodzi poza [p, koniec).
+inline bool czytajVarint(const char*& p, const char* koniec, uint64_t& wartosc) {
+    wartosc = 0;
+    for (int przesuniecie = 0; p < koniec && przesuniecie < 64; przesuniecie += 7) {
+        uint8_t bajt = (uint8_t)*p++;
+        wartosc |= (uint64_t)(bajt & 0x7f) << przesuniecie;
+        if (!(bajt & 0x80)) return true;
+    }
+    return false;
+}
+
+template <typename T>
+void dopiszSurowo(std::vector<char>& bufor, const T& wartosc) {
+    const char* bajty = reinterpret_cast<const char*>(&wartosc);
+    bufor.insert(bufor.end(), bajty, bajty + sizeof(T));
+}
+
+inline void dopiszNaglowekCsv(std::vector<char>& bufor, int filozofow, int paleczek) {
+    char pole[32];
+    const char* poczatek = "czas_s,mysli,glodni,jedza";
+    bufor.insert(bufor.end(), poczatek, poczatek + strlen(poczatek));
+    for (int i = 0; i < filozofow; ++i) {
+        int dlugosc = snprintf(pole, sizeof(pole), ",posilki_%d", i);
+        bufor.insert(bufor.end(), pole, pole + dlugosc);
+    }
+    for (int i = 0; i < paleczek; ++i) {
+        int dlugosc = snprintf(pole, sizeof(pole), ",paleczka_%d", i);
+        bufor.insert(bufor.end(), pole, pole + dlugosc);
+    }
+    bufor.push_back('\n');
+}
+
+inline void dopiszWierszCsv(std::vector<char>& bufor, const ProbkaMetryk& probka) {
+    char pole[64];
+    int dlugosc = snprintf(pole, sizeof(pole), "%.6f,%u,%u,%u", probka.czasNs / 1e9,
+                           probka.mysli, probka.glodni, probka.jedza);
+    bufor.insert(bufor.end(), pole, pole + dlugosc);
+    for (int32_t posilki : probka.posilki) {
+        dlugosc = snprintf(pole, sizeof(pole), ",%d", posilki);
+        bufor.insert(bufor.end(), pole, pole + dlugosc);
+    }
+    for (int32_t wlasciciel : probka.wlasciciele) {
+        dlugosc = snprintf(pole, sizeof(pole), ",%d", wlasciciel);
+        bufor.insert(bufor.end(), pole, pole + dlugosc);
+    }
+    bufor.push_back('\n');
+}
+
+
+class ZapisMetryk {
+public:
+    // Bufor oddajemy do zapisu, gdy przekroczy tyle bajtów.
+    static const size_t PROG_ZAPISU = size_t(1) << 20;
+
+    ~ZapisMetryk() { zamknij(); }
+
+    bool otworz(const std::string& sciezka, bool csv, int filozofow, int paleczek, uint32_t okresUs) {
+        plik = fopen(sciezka.c_str(), "wb");
+        if (!plik) return false;
+        this->csv = csv;
+        poprzednieP.assign(filozofow, 0);
+        aktywny.reserve(PROG_ZAPISU * 2);
+        if (csv) {
+            dopiszNaglowekCsv(aktywny, filozofow, paleczek);
+        } else {
+            NaglowekMetryk naglowek;
+            memcpy(naglowek.magia, MAGIA_METRYK, sizeof(naglowek.magia));
+            naglowek.wersja = WERSJA_METRYK;
+            naglowek.filozofow = (uint32_t)filozofow;
+            naglowek.okresUs = okresUs;
+            naglowek.paleczek = (uint32_t)paleczek;
+            dopiszSurowo(aktywny, naglowek);
+        }
+        watekZapisu = std::thread([this] { petlaZapisu(); });
+        return true;
+    }
+
+    void dopisz(const ProbkaMetryk& probka) {
+        if (csv) {
+            dopiszWierszCsv(aktywny, probka);
+        } else {
+            size_t poczatek = aktywny.size();
+            dopiszSurowo(aktywny, (uint32_t)0); // Długość uzupełniamy na końcu
+            dopiszSurowo(aktywny, probka.czasNs);
+            dopiszSurowo(aktywny, probka.mysli);
+            dopiszSurowo(aktywny, probka.glodni);
+            dopiszSurowo(aktywny, probka.jedza);
+            for (size_t i = 0; i < probka.posilki.size(); ++i) {
+                dopiszVarint(aktywny, zigzag((int64_t)probka.posilki[i] - poprzednieP[i]));
+                poprzednieP[i] = probka.posilki[i];
+            }
+            for (size_t i = 0; i < probka.wlasciciele.size(); ++i) {
+                int32_t wlasciciel = probka.wlasciciele[i];
+                dopiszVarint(aktywny, wlasciciel < 0 ? 0 : zigzag((int64_t)wlasciciel - (int64_t)i) + 1);
+            }
+            uint32_t dlugosc = (uint32_t)(aktywny.size() - poczatek - sizeof(uint32_t));
+            memcpy(&aktywny[poczatek], &dlugosc, sizeof(dlugosc));
+        }
+        probek++;
+        if (aktywny.size() >= PROG_ZAPISU) oddajDoZapisu(false);
+    }
+
+    // Dopisuje resztę bufora i zamyka plik (czeka na wątek zapisu).
+    void zamknij() {
+        if (!plik) return;
+        oddajDoZapisu(true);
+        {
+            std::lock_guard<std::mutex> blokada(mutex);
+            koniec = true;
+        }
+        sygnal.notify_one();
+        watekZapisu.join();
+        fclose(plik);
+        plik = nullptr;
+    }
+
+    long long liczbaProbek() const { return probek; }
+    long long zapisanychBajtow() const { return bajtow; }
+    // Ile razy bufor był pełny, a wątek zapisu jeszcze pisał poprzedni (dysk nie nadążał).
+    long long zaleglosci() const { return zalegle; }
+
+private:
+    void oddajDoZapisu(bool czekaj) {
+        std::unique_lock<std::mutex> blokada(mutex);
+        if (czekaj) sygnal.wait(blokada, [this] { return oczekujacy.empty(); });
+        if (!oczekujacy.empty()) {
+            zalegle++;
+            return; // Piszemy dalej do aktywnego - zostanie oddany razem z kolejną porcją.
+        }
+        oczekujacy.swap(aktywny);
+        aktywny.clear();
+        blokada.unlock();
+        sygnal.notify_all();
+    }
+
+    void petlaZapisu() {
+        std::unique_lock<std::mutex> blokada(mutex);
+        while (true) {
+            sygnal.wait(blokada, [this] { return !oczekujacy.empty() || koniec; });
+            if (oczekujacy.empty()) return;
+            blokada.unlock();
+            fwrite(oczekujacy.data(), 1, oczekujacy.size(), plik);
+            fflush(plik);
+            bajtow += (long long)oczekujacy.size();
+            blokada.lock();
+            oczekujacy.clear();
+            sygnal.notify_all();
+        }
+    }
+
+    FILE* plik = nullptr;
+    bool csv = false;
+    std::vector<int32_t> poprzednieP;
+    std::vector<char> aktywny;    // Tu dopisuje próbkujący
+    std::vector<char> oczekujacy; // Ten zapisuje wątek zapisu (pusty = wolny)
+    std::mutex mutex;
+    std::condition_variable sygnal;
+    std::thread watekZapisu;
+    bool koniec = false;
+    long long probek = 0;
+    long long bajtow = 0;
+    long long zalegle = 0;
+};
+
+
+/*
+ * Czytnik formatu binarnego. Rekordy czyta z pliku po kolei przez bufor o stałym
+ * rozmiarze (najdłuższy możliwy rekord), więc pamięć nie rośnie z długością przebiegu,
+ * i dekoduje je do jednej próbki (liczniki posiłków są sumowane z przyrostów).
+ */
+class CzytnikMetryk {
+public:
+    CzytnikMetryk() = default;
+    ~CzytnikMetryk() {
+        if (plik) fclose(plik);
+    }
+
+    CzytnikMetryk(const CzytnikMetryk&) = delete;
+    CzytnikMetryk& operator=(const CzytnikMetryk&) = delete;
+
+    bool otworz(const std::string& sciezka) {
+        plik = fopen(sciezka.c_str(), "rb");
+        if (!plik) return false;
+        if (fread(&naglowek, sizeof(naglowek), 1, plik) != 1) return false;
+        if (memcmp(naglowek.magia, MAGIA_METRYK, sizeof(MAGIA_METRYK)) != 0 || naglowek.wersja != WERSJA_METRYK) {
+            return false;
+        }
+        if (naglowek.paleczek == 0) naglowek.paleczek = naglowek.filozofow;
+        probka.posilki.assign(naglowek.filozofow, 0);
+        probka.wlasciciele.assign(naglowek.paleczek, -1);
+        // Varint 64-bitowy ma co najwyżej 10 bajtów - dłuższy rekord jest uszkodzony.
+        rekord.resize(STALE + 10 * ((size_t)naglowek.filozofow + naglowek.paleczek));
+        return true;
+    }
+
+    const NaglowekMetryk& opis() const { return naglowek; }
+
+    // Wczytuje kolejny rekord do probkaBiezaca(). false na końcu pliku albo przy urwanym rekordzie.
+    bool nastepna() {
+        uint32_t dlugosc;
+        if (!plik || fread(&dlugosc, sizeof(dlugosc), 1, plik) != 1) return false;
+        if (dlugosc < STALE || dlugosc > rekord.size()) return false;
+        if (fread(rekord.data(), 1, dlugosc, plik) != dlugosc) return false;
+        const char* p = rekord.data();
+        const char* koniec = p + dlugosc;
+        memcpy(&probka.czasNs, p, sizeof(uint64_t));
+        memcpy(&probka.mysli, p + 8, sizeof(uint32_t));
+        memcpy(&probka.glodni, p + 12, sizeof(uint32_t));
+        memcpy(&probka.jedza, p + 16, sizeof(uint32_t));
+        p += STALE;
+        uint64_t wartosc;
+        for (uint32_t i = 0; i < naglowek.filozofow; ++i) {
+            if (!czytajVarint(p, koniec, wartosc)) return false;
+            probka.posilki[i] += (int32_t)odZigzag(wartosc);
+        }
+        for (uint32_t i = 0; i < naglowek.paleczek; ++i) {
+            if (!czytajVarint(p, koniec, wartosc)) return false;
+            probka.wlasciciele[i] = wartosc == 0 ? -1 : (int32_t)(odZigzag(wartosc - 1) + i);
+        }
+        return true;
+    }
+
+    const ProbkaMetryk& probkaBiezaca() const { return probka; }
+
+private:
+    // Stała część rekordu: chwila (u64) i trzy liczniki stanów (u32).
+    static const size_t STALE = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+
+    FILE* plik = nullptr;
+    std::vector<char> rekord;
+    NaglowekMetryk naglowek{};
+    ProbkaMetryk probka;
+};
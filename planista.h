@@ -0,0 +1,263 @@
+#pragma once
+
+/*
+ * Planista zadań z podkradaniem pracy (work stealing).
+ *
+ * Zamiast jednego wątku systemowego na filozofa mamy stałą pulę pracowników
+ * (domyślnie jeden na rdzeń). Zadanie to numer filozofa; planista wywołuje dla niego
+ * funkcję kroku, która nigdy nie blokuje - zwraca tylko, kiedy zadanie ma się obudzić
+ * (myślenie / jedzenie) albo że trzeba spróbować ponownie (pałeczka zajęta).
+ *
+ *  - każdy pracownik ma własną kolejkę dwustronną Chase-Lev: sam bierze z dołu (LIFO),
+ *    a bezczynni pracownicy podkradają z góry (FIFO),
+ *  - czekanie na czas to koło czasowe (timer wheel) pracownika zamiast sleep_for,
+ *  - zadania, którym nie udało się zdobyć pałeczki (albo gotowe od razu), czekają
+ *    na liście odłożonych pracownika i wracają do kolejki, gdy kolejka się opróżni.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+// Wynik jednego kroku zadania.
+struct WynikKroku {
+    bool ponow;                                    // true = zasób zajęty, spróbuj później
+    std::chrono::steady_clock::time_point budzik;  // gdy !ponow - kiedy wykonać następny krok
+};
+
+
+/*
+ * Kolejka Chase-Lev ("Dynamic Circular Work-Stealing Deque", w wersji z modelem pamięci C11
+ * wg Lê i in.). Stała pojemność - każde zadanie jest naraz w co najwyżej jednym miejscu,
+ * więc wystarczy pojemność równa liczbie zadań.
+ */
+class KolejkaKradziezy {
+public:
+    explicit KolejkaKradziezy(int minimalnaPojemnosc) {
+        size_t pojemnosc = 1;
+        while (pojemnosc < (size_t)minimalnaPojemnosc) pojemnosc *= 2;
+        maska = pojemnosc - 1;
+        bufor.reset(new std::atomic<int>[pojemnosc]);
+    }
+
+    // Tylko właściciel.
+    void wstaw(int zadanie) {
+        long long d = dol.load(std::memory_order_relaxed);
+        bufor[d & maska].store(zadanie, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        dol.store(d + 1, std::memory_order_relaxed);
+    }
+
+    // Tylko właściciel. Zwraca -1, gdy pusto.
+    int zdejmij() {
+        long long d = dol.load(std::memory_order_relaxed) - 1;
+        dol.store(d, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long g = gora.load(std::memory_order_relaxed);
+        if (g > d) {
+            dol.store(d + 1, std::memory_order_relaxed);
+            return -1;
+        }
+        int zadanie = bufor[d & maska].load(std::memory_order_relaxed);
+        if (g == d) {
+            // Ostatni element - ścigamy się ze złodziejami.
+            if (!gora.compare_exchange_strong(g, g + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                zadanie = -1;
+            }
+            dol.store(d + 1, std::memory_order_relaxed);
+        }
+        return zadanie;
+    }
+
+    // Dowolny inny pracownik. Zwraca -1, gdy pusto albo przegraliśmy wyścig.
+    int ukradnij() {
+        long long g = gora.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long d = dol.load(std::memory_order_acquire);
+        if (g >= d) return -1;
+        int zadanie = bufor[g & maska].load(std::memory_order_relaxed);
+        if (!gora.compare_exchange_strong(g, g + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return -1;
+        }
+        return zadanie;
+    }
+
+private:
+    alignas(64) std::atomic<long long> gora{0};
+    alignas(64) std::atomic<long long> dol{0};
+    std::unique_ptr<std::atomic<int>[]> bufor;
+    size_t maska = 0;
+};
+
+
+/*
+ * Koło czasowe (hashed timer wheel): SLOTY przegródek po jednym "tyknięciu".
+ * Zadanie z budzikiem za t tyknięć trafia do przegródki t % SLOTY; przy przejściu
+ * przez przegródkę odpalamy tylko te wpisy, których czas już minął (dalsze czekają
+ * na kolejny obrót koła). Dodanie i odpalenie kosztuje O(1) na zadanie.
+ */
+class KoloCzasowe {
+public:
+    static const int SLOTY = 4096;
+
+    KoloCzasowe() : przegrodki(SLOTY) {}
+
+    void dodaj(long long tykniecie, int zadanie) {
+        przegrodki[tykniecie % SLOTY].push_back({ tykniecie, zadanie });
+        liczbaWpisow++;
+    }
+
+    // Przesuwa koło do `teraz` i woła odpal(zadanie) dla każdego zadania, którego czas minął.
+    template <typename Odpal>
+    void przesun(long long teraz, Odpal odpal) {
+        if (teraz <= biezace) return;
+        // Po dłuższej przerwie wystarczy jeden pełny obrót.
+        long long od = std::max(biezace + 1, teraz - SLOTY + 1);
+        for (long long t = od; t <= teraz && liczbaWpisow > 0; ++t) {
+            std::vector<Wpis>& przegrodka = przegrodki[t % SLOTY];
+            size_t zostaje = 0;
+            for (size_t i = 0; i < przegrodka.size(); ++i) {
+                if (przegrodka[i].tykniecie <= teraz) {
+                    liczbaWpisow--;
+                    odpal(przegrodka[i].zadanie);
+                } else {
+                    przegrodka[zostaje++] = przegrodka[i];
+                }
+            }
+            przegrodka.resize(zostaje);
+        }
+        biezace = teraz;
+    }
+
+private:
+    struct Wpis {
+        long long tykniecie;
+        int zadanie;
+    };
+    std::vector<std::vector<Wpis>> przegrodki;
+    long long biezace = 0;
+    size_t liczbaWpisow = 0;
+};
+
+
+class PlanistaZadan {
+public:
+    typedef WynikKroku (*FunkcjaKroku)(int zadanie, std::chrono::steady_clock::time_point teraz);
+
+    // Rozdzielczość koła czasowego.
+    static constexpr long long TYKNIECIE_NS = 100000; // 100 us
+
+    PlanistaZadan(int liczbaPracownikow, int liczbaZadan, FunkcjaKroku krok)
+        : krok(krok), start(std::chrono::steady_clock::now()) {
+        for (int i = 0; i < liczbaPracownikow; ++i) {
+            pracownicy.emplace_back(new Pracownik(liczbaZadan));
+        }
+        // Na początek zadania rozdajemy po kolei wszystkim pracownikom.
+        for (int z = 0; z < liczbaZadan; ++z) {
+            pracownicy[z % liczbaPracownikow]->kolejka.wstaw(z);
+        }
+    }
+
+    // Startuje pracowników; działają, dopóki `dziala` jest true.
+    void uruchom(const std::atomic<bool>& dziala) {
+        for (size_t i = 0; i < pracownicy.size(); ++i) {
+            watki.emplace_back([this, i, &dziala] { petlaPracownika((int)i, dziala); });
+        }
+    }
+
+    void dolacz() {
+        for (auto& watek : watki) watek.join();
+        watki.clear();
+    }
+
+    int liczbaPracownikow() const { return (int)pracownicy.size(); }
+
+    long long liczbaKradziezy() const {
+        long long suma = 0;
+        for (const auto& p : pracownicy) suma += p->kradzieze.load(std::memory_order_relaxed);
+        return suma;
+    }
+
+private:
+    struct alignas(64) Pracownik {
+        explicit Pracownik(int liczbaZadan) : kolejka(liczbaZadan) {}
+        KolejkaKradziezy kolejka;
+        KoloCzasowe kolo;
+        std::vector<int> odlozone; // Do wykonania w następnej rundzie
+        std::atomic<long long> kradzieze{0};
+    };
+
+    long long tykniecie(std::chrono::steady_clock::time_point chwila) const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(chwila - start).count()
+               / TYKNIECIE_NS;
+    }
+
+    // Zaokrąglenie w górę - budzik nie może odpalić przed swoim czasem.
+    long long tykniecieWGore(std::chrono::steady_clock::time_point chwila) const {
+        return (std::chrono::duration_cast<std::chrono::nanoseconds>(chwila - start).count()
+                + TYKNIECIE_NS - 1) / TYKNIECIE_NS;
+    }
+
+    void petlaPracownika(int numer, const std::atomic<bool>& dziala) {
+        Pracownik& ja = *pracownicy[numer];
+        std::mt19937 generator(numer * 7919u + 1);
+        int n = (int)pracownicy.size();
+        // Czy od ostatniego dołożenia odłożonych zadań któreś zrobiło postęp.
+        bool postep = true;
+
+        while (dziala.load(std::memory_order_relaxed)) {
+            auto teraz = std::chrono::steady_clock::now();
+            ja.kolo.przesun(tykniecie(teraz), [&](int zadanie) { ja.kolejka.wstaw(zadanie); });
+
+            int zadanie = ja.kolejka.zdejmij();
+            if (zadanie < 0 && !ja.odlozone.empty()) {
+                // Kolejka pusta - kolejna runda dla odłożonych zadań. Jeśli w poprzedniej
+                // nikt nie ruszył z miejsca (same zajęte pałeczki), oddajemy procesor.
+                if (!postep) std::this_thread::yield();
+                for (int z : ja.odlozone) ja.kolejka.wstaw(z);
+                ja.odlozone.clear();
+                postep = false;
+                continue;
+            }
+            if (zadanie < 0 && n > 1) {
+                // Podkradamy od losowo wybranego pracownika, potem od kolejnych.
+                int pierwszy = std::uniform_int_distribution<int>(0, n - 1)(generator);
+                for (int k = 0; k < n && zadanie < 0; ++k) {
+                    int ofiara = (pierwszy + k) % n;
+                    if (ofiara != numer) zadanie = pracownicy[ofiara]->kolejka.ukradnij();
+                }
+                if (zadanie >= 0) ja.kradzieze.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (zadanie < 0) {
+                // Bezczynność - drzemka na jedno tyknięcie koła.
+                std::this_thread::sleep_for(std::chrono::nanoseconds(TYKNIECIE_NS));
+                continue;
+            }
+
+            WynikKroku wynik = krok(zadanie, teraz);
+            if (!wynik.ponow) postep = true;
+            if (wynik.ponow || wynik.budzik <= teraz) {
+                /*
+                 * Zadanie gotowe od razu (albo czekające na pałeczkę) idzie na koniec
+                 * rundy, a nie z powrotem na dół kolejki - inaczej LIFO brałoby je
+                 * w kółko i reszta zadań by stała.
+                 */
+                ja.odlozone.push_back(zadanie);
+            } else {
+                ja.kolo.dodaj(tykniecieWGore(wynik.budzik), zadanie);
+            }
+        }
+    }
+
+    FunkcjaKroku krok;
+    std::chrono::steady_clock::time_point start;
+    std::vector<std::unique_ptr<Pracownik>> pracownicy;
+    std::vector<std::thread> watki;
+};
@@ -0,0 +1,445 @@
+/*
+ * Przegląd parametrów (parameter sweep) dla ProjektSO1 --benchmark.
+ *
+ *   PrzegladParametrow --strategie 2,3,4 --filozofow 5,64 --myslenie 0,1:3 --jedzenie 0
+ *                      --blokady mutex,futex --powtorzen 5 --czas 2 [--csv WYNIKI.csv]
+ *                      [-- dodatkowe opcje ProjektSO1, np. --ponawianie wykladnicza]
+ *
+ * Każda kombinacja siatki (strategia x filozofów x myślenie x jedzenie x blokada) jest
+ * uruchamiana --powtorzen razy, każde uruchomienie to osobny proces ProjektSO1 - własna
+ * pamięć i liczniki, a zakleszczenie jednego nie dotyka pozostałych. Procesy działają
+ * równolegle, ale bez przeciążania maszyny: uruchomienie rezerwuje tyle procesorów, ile
+ * może naraz zająć (wątki - min(filozofów, rdzeni), zadania - pracowników, korutyny - 1;
+ * filozofów liczymy tak jak ProjektSO1 - siatka/torus WxH i plik mają ich własną liczbę),
+ * jest do nich przypięte (sched_setaffinity przed exec) i startuje dopiero, gdy tyle
+ * procesorów jest wolnych. Powtórzenia tej samej kombinacji są rozłożone w czasie
+ * (najpierw pierwsze powtórzenie wszystkich kombinacji, potem drugie...).
+ *
+ * Wynik: tabela ze średnią i 95% przedziałem ufności (t-Studenta) z powtórzeń,
+ * opcjonalnie CSV z tymi samymi wartościami.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "topologia.h"
+
+using namespace std;
+
+
+// Mierzone wielkości - kolejność kolumn tabeli i CSV.
+enum Miara { POSILKI_NA_S, CPU_US_NA_POSILEK, CZEKANIE_P99_US, SPRAWIEDLIWOSC, LICZBA_MIAR };
+const char* NAZWY_MIAR[LICZBA_MIAR] = { "posilki_na_s", "cpu_us_na_posilek", "czekanie_p99_us",
+                                        "min_do_sredniej" };
+
+struct Kombinacja {
+    string strategia;
+    int filozofow;
+    string myslenie;
+    string jedzenie;
+    string blokada;
+    int procesorow = 1;                 // Ile procesorów rezerwuje jedno uruchomienie
+    vector<double> wartosci[LICZBA_MIAR];
+    int zakleszczen = 0;
+    int bledow = 0;
+};
+
+// Jedno uruchomienie w toku.
+struct Uruchomienie {
+    int kombinacja;
+    pid_t pid;
+    int wyjscie;                        // Potok ze stdout procesu
+    string odczytane;
+    vector<int> procesory;
+    chrono::steady_clock::time_point limit;
+};
+
+struct KonfiguracjaPrzegladu {
+    vector<string> strategie = { "4" };
+    vector<string> filozofow = { "5" };
+    vector<string> myslenie = { "0" };
+    vector<string> jedzenie = { "0" };
+    vector<string> blokady = { "mutex" };
+    int powtorzen = 3;
+    string czas = "2";
+    string program;
+    string plikCsv;
+    int rdzeni = 0;                     // 0 = tyle, ile procesorów wolno nam używać
+    vector<string> dodatkowe;           // Po "--", przekazywane każdemu uruchomieniu
+};
+
+
+vector<string> podziel(const string& lista) {
+    vector<string> wynik;
+    size_t i = 0;
+    while (i <= lista.size()) {
+        size_t koniec = lista.find(',', i);
+        if (koniec == string::npos) koniec = lista.size();
+        if (koniec > i) wynik.push_back(lista.substr(i, koniec - i));
+        i = koniec + 1;
+    }
+    return wynik;
+}
+
+// Wartość liczbowa klucza `"klucz":` w JSON, szukana od pozycji `od` (NAN, gdy brak).
+double liczbaZJson(const string& json, const string& klucz, size_t od = 0) {
+    size_t i = json.find("\"" + klucz + "\":", od);
+    if (i == string::npos) return NAN;
+    return strtod(json.c_str() + i + klucz.size() + 3, nullptr);
+}
+
+// Dwustronny kwantyl 97.5% rozkładu t-Studenta dla `stopni` stopni swobody.
+double kwantylT(int stopni) {
+    static const double tablica[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                      2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                      2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (stopni < 1) return NAN;
+    if (stopni <= 30) return tablica[stopni - 1];
+    return 1.96;
+}
+
+// Średnia i połowa szerokości 95% przedziału ufności (0, gdy jest jeden pomiar).
+void sredniaIPrzedzial(const vector<double>& wartosci, double& srednia, double& polowa) {
+    srednia = NAN;
+    polowa = 0;
+    if (wartosci.empty()) return;
+    double suma = 0;
+    for (double w : wartosci) suma += w;
+    srednia = suma / wartosci.size();
+    if (wartosci.size() < 2) return;
+    double kwadraty = 0;
+    for (double w : wartosci) kwadraty += (w - srednia) * (w - srednia);
+    double odchylenie = sqrt(kwadraty / (wartosci.size() - 1));
+    polowa = kwantylT((int)wartosci.size() - 1) * odchylenie / sqrt((double)wartosci.size());
+}
+
+void wypiszPomoc(const char* program) {
+    printf("Uzycie: %s [opcje] [-- opcje ProjektSO1]\n", program);
+    printf("  --strategie L            numery strategii, np. 2,3,4 (domyslnie 4)\n");
+    printf("  --filozofow L            liczby filozofow, np. 5,64 (domyslnie 5)\n");
+    printf("  --myslenie L             zakresy myslenia MIN[:MAX] w ms, np. 0,1:5 (domyslnie 0)\n");
+    printf("  --jedzenie L             zakresy jedzenia MIN[:MAX] w ms (domyslnie 0)\n");
+    printf("  --blokady L              typy paleczek, np. mutex,futex (domyslnie mutex)\n");
+    printf("  --powtorzen N            uruchomien kazdej kombinacji (domyslnie 3)\n");
+    printf("  --czas S                 czas jednego uruchomienia w s (domyslnie 2)\n");
+    printf("  --rdzenie N              ile procesorow moga zajac naraz wszystkie uruchomienia\n");
+    printf("                           (domyslnie wszystkie dostepne)\n");
+    printf("  --program SCIEZKA        ProjektSO1 (domyslnie obok tego programu)\n");
+    printf("  --csv PLIK               zapisz tez wyniki jako CSV\n");
+    printf("  po --                    opcje dla kazdego uruchomienia (np. --wykonanie zadania)\n");
+}
+
+bool parsujArgumenty(int argc, char** argv, KonfiguracjaPrzegladu& konfig) {
+    for (int i = 1; i < argc; ++i) {
+        string opcja = argv[i];
+        if (opcja == "--") {
+            konfig.dodatkowe.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Brak wartosci dla opcji %s\n", opcja.c_str());
+            return false;
+        }
+        string wartosc = argv[++i];
+        if (opcja == "--strategie") konfig.strategie = podziel(wartosc);
+        else if (opcja == "--filozofow") konfig.filozofow = podziel(wartosc);
+        else if (opcja == "--myslenie") konfig.myslenie = podziel(wartosc);
+        else if (opcja == "--jedzenie") konfig.jedzenie = podziel(wartosc);
+        else if (opcja == "--blokady") konfig.blokady = podziel(wartosc);
+        else if (opcja == "--powtorzen") konfig.powtorzen = atoi(wartosc.c_str());
+        else if (opcja == "--czas") konfig.czas = wartosc;
+        else if (opcja == "--rdzenie") konfig.rdzeni = atoi(wartosc.c_str());
+        else if (opcja == "--program") konfig.program = wartosc;
+        else if (opcja == "--csv") konfig.plikCsv = wartosc;
+        else {
+            fprintf(stderr, "Nieznana opcja %s\n", opcja.c_str());
+            return false;
+        }
+    }
+    if (konfig.powtorzen < 1 || atof(konfig.czas.c_str()) <= 0 || konfig.strategie.empty()
+        || konfig.filozofow.empty() || konfig.myslenie.empty() || konfig.jedzenie.empty() || konfig.blokady.empty()) {
+        return false;
+    }
+    for (const string& n : konfig.filozofow) {
+        if (atoi(n.c_str()) < 2) return false;
+    }
+    return true;
+}
+
+// ProjektSO1 z tego samego katalogu co przegląd (ścieżka z /proc/self/exe).
+string domyslnyProgram() {
+    char sciezka[PATH_MAX];
+    ssize_t dlugosc = readlink("/proc/self/exe", sciezka, sizeof(sciezka) - 1);
+    if (dlugosc <= 0) return "./ProjektSO1";
+    string katalog(sciezka, dlugosc);
+    return katalog.substr(0, katalog.rfind('/') + 1) + "ProjektSO1";
+}
+
+// Wartość opcji z listy dodatkowych (pusty napis, gdy jej nie podano).
+string opcjaDodatkowa(const KonfiguracjaPrzegladu& konfig, const char* nazwa) {
+    for (size_t i = 0; i + 1 < konfig.dodatkowe.size(); ++i) {
+        if (konfig.dodatkowe[i] == nazwa) return konfig.dodatkowe[i + 1];
+    }
+    return "";
+}
+
+/*
+ * Ilu filozofów będzie miało uruchomienie z --filozofow `filozofow`: topologie siatka:WxH,
+ * torus:WxH i plik:SCIEZKA same wyznaczają liczbę (jak zbudujTopologie w ProjektSO1).
+ */
+int filozofowUruchomienia(const KonfiguracjaPrzegladu& konfig, int filozofow) {
+    string opis = opcjaDodatkowa(konfig, "--topologia");
+    int szerokosc = 0, wysokosc = 0;
+    if (sscanf(opis.c_str(), "siatka:%dx%d", &szerokosc, &wysokosc) == 2
+        || sscanf(opis.c_str(), "torus:%dx%d", &szerokosc, &wysokosc) == 2) {
+        if (szerokosc > 0 && wysokosc > 0) return szerokosc * wysokosc;
+    } else if (opis.rfind("plik:", 0) == 0) {
+        Topologia topologia;
+        string blad;
+        if (Topologia::zPliku(opis.substr(5), topologia, blad)) return topologia.liczbaAgentow();
+    }
+    return filozofow;
+}
+
+// Ile procesorów może naraz zająć uruchomienie z --filozofow `filozofow`.
+int procesorowUruchomienia(const KonfiguracjaPrzegladu& konfig, int filozofow, int rdzeni) {
+    filozofow = filozofowUruchomienia(konfig, filozofow);
+    string wykonanie = opcjaDodatkowa(konfig, "--wykonanie");
+    if (wykonanie == "korutyny") return 1;
+    if (wykonanie == "zadania") {
+        int pracownicy = atoi(opcjaDodatkowa(konfig, "--pracownicy").c_str());
+        return pracownicy > 0 ? min(pracownicy, rdzeni) : rdzeni;
+    }
+    return min(filozofow, rdzeni);
+}
+
+// Uruchamia ProjektSO1 --benchmark dla kombinacji, przypięty do `procesory`.
+bool uruchom(const KonfiguracjaPrzegladu& konfig, const Kombinacja& kombinacja, Uruchomienie& uruchomienie) {
+    vector<string> argumenty = { konfig.program, "--benchmark", "--strategia", kombinacja.strategia,
+                                 "--filozofow", to_string(kombinacja.filozofow), "--myslenie", kombinacja.myslenie,
+                                 "--jedzenie", kombinacja.jedzenie, "--blokada", kombinacja.blokada,
+                                 "--czas", konfig.czas };
+    argumenty.insert(argumenty.end(), konfig.dodatkowe.begin(), konfig.dodatkowe.end());
+    int potok[2];
+    if (pipe(potok) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(potok[0]);
+        close(potok[1]);
+        return false;
+    }
+    if (pid == 0) {
+        cpu_set_t zbior;
+        CPU_ZERO(&zbior);
+        for (int p : uruchomienie.procesory) CPU_SET(p, &zbior);
+        sched_setaffinity(0, sizeof(zbior), &zbior);
+        dup2(potok[1], STDOUT_FILENO);
+        close(potok[0]);
+        close(potok[1]);
+        vector<char*> argv;
+        for (string& a : argumenty) argv.push_back(a.data());
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(potok[1]);
+    uruchomienie.pid = pid;
+    uruchomienie.wyjscie = potok[0];
+    // Zapas na start wątków i zakończenie (zakleszczony benchmark czeka jeszcze na wątki).
+    uruchomienie.limit = chrono::steady_clock::now()
+        + chrono::milliseconds((long long)(atof(konfig.czas.c_str()) * 3000) + 30000);
+    return true;
+}
+
+// ProjektSO1 --benchmark kończy się kodem 0, a 2 przy wykrytym zakleszczeniu - to też pomiar.
+bool zakonczonePoprawnie(int status) {
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0 || WEXITSTATUS(status) == 2);
+}
+
+// Zapisuje wynik zakończonego uruchomienia w kombinacji.
+void zbierzWynik(Kombinacja& kombinacja, const Uruchomienie& uruchomienie, int status) {
+    const string& json = uruchomienie.odczytane;
+    double posilki = liczbaZJson(json, "posilki_na_s");
+    if (!zakonczonePoprawnie(status) || std::isnan(posilki)) {
+        kombinacja.bledow++;
+        return;
+    }
+    if (json.find("\"zakleszczenie\":true") != string::npos) kombinacja.zakleszczen++;
+    kombinacja.wartosci[POSILKI_NA_S].push_back(posilki);
+    kombinacja.wartosci[CPU_US_NA_POSILEK].push_back(liczbaZJson(json, "cpu_us_na_posilek"));
+    size_t czekanie = json.find("\"oczekiwanie_us\":");
+    if (czekanie != string::npos) kombinacja.wartosci[CZEKANIE_P99_US].push_back(liczbaZJson(json, "p99", czekanie));
+    size_t sprawiedliwosc = json.find("\"sprawiedliwosc\":");
+    double srednia = liczbaZJson(json, "srednia", sprawiedliwosc);
+    if (srednia > 0) kombinacja.wartosci[SPRAWIEDLIWOSC].push_back(liczbaZJson(json, "min", sprawiedliwosc) / srednia);
+}
+
+void wypiszTabele(const vector<Kombinacja>& kombinacje) {
+    printf("%-10s %-8s %6s %-7s %-7s %4s %22s %16s %20s %14s %6s\n", "strategia", "blokada", "N", "mysl",
+           "jedz", "ile", "posilki/s", "cpu us/posilek", "czekanie p99 us", "min/sr posilk", "zaklesz");
+    for (const Kombinacja& k : kombinacje) {
+        double s[LICZBA_MIAR], p[LICZBA_MIAR];
+        for (int m = 0; m < LICZBA_MIAR; ++m) sredniaIPrzedzial(k.wartosci[m], s[m], p[m]);
+        printf("%-10s %-8s %6d %-7s %-7s %4zu %12.0f +-%7.0f %8.3f +-%5.3f %11.1f +-%6.1f %6.3f +-%5.3f %3d/%zu",
+               k.strategia.c_str(), k.blokada.c_str(), k.filozofow, k.myslenie.c_str(), k.jedzenie.c_str(),
+               k.wartosci[POSILKI_NA_S].size(), s[POSILKI_NA_S], p[POSILKI_NA_S], s[CPU_US_NA_POSILEK],
+               p[CPU_US_NA_POSILEK], s[CZEKANIE_P99_US], p[CZEKANIE_P99_US], s[SPRAWIEDLIWOSC], p[SPRAWIEDLIWOSC],
+               k.zakleszczen, k.wartosci[POSILKI_NA_S].size());
+        if (k.bledow > 0) printf("  (bledow: %d)", k.bledow);
+        printf("\n");
+    }
+}
+
+bool zapiszCsv(const string& sciezka, const vector<Kombinacja>& kombinacje) {
+    FILE* plik = fopen(sciezka.c_str(), "w");
+    if (!plik) return false;
+    fprintf(plik, "strategia,blokada,filozofow,myslenie_ms,jedzenie_ms,uruchomien,zakleszczen,bledow");
+    for (int m = 0; m < LICZBA_MIAR; ++m) fprintf(plik, ",%s,%s_ci95", NAZWY_MIAR[m], NAZWY_MIAR[m]);
+    fprintf(plik, "\n");
+    for (const Kombinacja& k : kombinacje) {
+        fprintf(plik, "%s,%s,%d,%s,%s,%zu,%d,%d", k.strategia.c_str(), k.blokada.c_str(), k.filozofow,
+                k.myslenie.c_str(), k.jedzenie.c_str(), k.wartosci[POSILKI_NA_S].size(), k.zakleszczen, k.bledow);
+        for (int m = 0; m < LICZBA_MIAR; ++m) {
+            double srednia, polowa;
+            sredniaIPrzedzial(k.wartosci[m], srednia, polowa);
+            fprintf(plik, ",%.6g,%.6g", srednia, polowa);
+        }
+        fprintf(plik, "\n");
+    }
+    fclose(plik);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    KonfiguracjaPrzegladu konfig;
+    if (!parsujArgumenty(argc, argv, konfig)) {
+        wypiszPomoc(argv[0]);
+        return 1;
+    }
+    if (konfig.program.empty()) konfig.program = domyslnyProgram();
+    if (access(konfig.program.c_str(), X_OK) != 0) {
+        fprintf(stderr, "Nie znaleziono programu %s (opcja --program)\n", konfig.program.c_str());
+        return 1;
+    }
+
+    // Procesory do rozdzielania między uruchomienia.
+    vector<int> wolne;
+    cpu_set_t zbior;
+    CPU_ZERO(&zbior);
+    if (sched_getaffinity(0, sizeof(zbior), &zbior) == 0) {
+        for (int i = 0; i < CPU_SETSIZE; ++i) {
+            if (CPU_ISSET(i, &zbior)) wolne.push_back(i);
+        }
+    }
+    if (wolne.empty()) wolne.push_back(0);
+    if (konfig.rdzeni > 0 && konfig.rdzeni < (int)wolne.size()) wolne.resize(konfig.rdzeni);
+    int rdzeni = (int)wolne.size();
+
+    vector<Kombinacja> kombinacje;
+    for (const string& strategia : konfig.strategie) {
+        for (const string& blokada : konfig.blokady) {
+            for (const string& n : konfig.filozofow) {
+                for (const string& myslenie : konfig.myslenie) {
+                    for (const string& jedzenie : konfig.jedzenie) {
+                        Kombinacja k;
+                        k.strategia = strategia;
+                        k.blokada = blokada;
+                        k.filozofow = atoi(n.c_str());
+                        k.myslenie = myslenie;
+                        k.jedzenie = jedzenie;
+                        k.procesorow = procesorowUruchomienia(konfig, k.filozofow, rdzeni);
+                        kombinacje.push_back(k);
+                    }
+                }
+            }
+        }
+    }
+    // Kolejka: najpierw pierwsze powtórzenie każdej kombinacji, potem drugie itd.
+    vector<int> kolejka;
+    for (int p = 0; p < konfig.powtorzen; ++p) {
+        for (int k = 0; k < (int)kombinacje.size(); ++k) kolejka.push_back(k);
+    }
+    int wszystkich = (int)kolejka.size();
+    fprintf(stderr, "Przeglad: %zu kombinacji x %d powtorzen, %d procesorow\n", kombinacje.size(),
+            konfig.powtorzen, rdzeni);
+
+    signal(SIGPIPE, SIG_IGN);
+    vector<Uruchomienie> trwajace;
+    int zakonczonych = 0;
+    while (!kolejka.empty() || !trwajace.empty()) {
+        /*
+         * Startujemy z kolejki wszystko, co się mieści w wolnych procesorach - także
+         * uruchomienia dalej w kolejce, gdy pierwsze czekające potrzebuje więcej.
+         */
+        for (size_t i = 0; i < kolejka.size(); ++i) {
+            Kombinacja& kombinacja = kombinacje[kolejka[i]];
+            if (kombinacja.procesorow > (int)wolne.size()) continue;
+            Uruchomienie uruchomienie;
+            uruchomienie.kombinacja = kolejka[i];
+            uruchomienie.procesory.assign(wolne.begin(), wolne.begin() + kombinacja.procesorow);
+            if (!uruchom(konfig, kombinacja, uruchomienie)) {
+                fprintf(stderr, "Nie udalo sie uruchomic procesu: %s\n", strerror(errno));
+                return 1;
+            }
+            wolne.erase(wolne.begin(), wolne.begin() + kombinacja.procesorow);
+            trwajace.push_back(uruchomienie);
+            kolejka.erase(kolejka.begin() + i);
+            --i;
+        }
+        vector<pollfd> czekane;
+        for (const Uruchomienie& u : trwajace) czekane.push_back({ u.wyjscie, POLLIN, 0 });
+        poll(czekane.data(), czekane.size(), 200);
+        auto teraz = chrono::steady_clock::now();
+        for (size_t i = 0; i < trwajace.size(); ++i) {
+            Uruchomienie& u = trwajace[i];
+            bool koniec = false;
+            if (czekane[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                char bufor[4096];
+                ssize_t ile = read(u.wyjscie, bufor, sizeof(bufor));
+                if (ile > 0) u.odczytane.append(bufor, ile);
+                else koniec = true;
+            }
+            if (!koniec && teraz > u.limit) {
+                // Proces nie skończył w rozsądnym czasie - liczymy jako błąd.
+                kill(u.pid, SIGKILL);
+                koniec = true;
+            }
+            if (!koniec) continue;
+            close(u.wyjscie);
+            int status = 0;
+            waitpid(u.pid, &status, 0);
+            Kombinacja& kombinacja = kombinacje[u.kombinacja];
+            zbierzWynik(kombinacja, u, status);
+            zakonczonych++;
+            fprintf(stderr, "[%d/%d] strategia %s, %s, N=%d, mysl %s, jedz %s%s\n", zakonczonych, wszystkich,
+                    kombinacja.strategia.c_str(), kombinacja.blokada.c_str(), kombinacja.filozofow,
+                    kombinacja.myslenie.c_str(), kombinacja.jedzenie.c_str(),
+                    zakonczonePoprawnie(status) ? "" : " - BLAD");
+            wolne.insert(wolne.end(), u.procesory.begin(), u.procesory.end());
+            sort(wolne.begin(), wolne.end());
+            trwajace.erase(trwajace.begin() + i);
+            czekane.erase(czekane.begin() + i);
+            --i;
+        }
+    }
+
+    wypiszTabele(kombinacje);
+    if (!konfig.plikCsv.empty() && !zapiszCsv(konfig.plikCsv, kombinacje)) {
+        fprintf(stderr, "Nie udalo sie zapisac %s\n", konfig.plikCsv.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+/*
+ * Przeszukiwanie przestrzeni stanów wszerz (BFS) na wielu wątkach - sprawdzanie modelu.
+ *
+ * Stan to liczba 64-bitowa (pakuje go model). Odwiedzone stany trzymamy w tablicy
+ * z adresowaniem otwartym bez blokad (ZbiorStanow): wstawienie to compare_exchange
+ * na pustym miejscu, a obok stanu zapisujemy rodzica - stan, z którego go odkryliśmy.
+ * Po znalezieniu błędu ścieżkę od stanu początkowego odtwarzamy, idąc po rodzicach.
+ *
+ * BFS idzie poziomami: wątki biorą bieżący poziom kawałkami (licznik atomowy), nowe
+ * stany zbierają do własnych list, a na barierze listy składają się w następny poziom.
+ * Tam też - gdy nikt nie wstawia - tablica rośnie dwukrotnie, kiedy jest zapełniona
+ * ponad połowę; stany, które w trakcie poziomu się nie zmieściły, wstawiamy po powiększeniu.
+ * Pierwszy znaleziony błąd ma więc najkrótszą ścieżkę (w grafie, który zwraca model -
+ * model może już redukować przeplot, np. zbiorami upartymi).
+ *
+ * Model dostarcza:
+ *   uint64_t poczatkowy() const;
+ *   void nastepniki(uint64_t stan, std::vector<uint64_t>& wynik) const;
+ *   bool koncowyPoprawny(uint64_t stan) const;  - stan bez następników, który nie jest błędem
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+class ZbiorStanow {
+public:
+    enum class Wstawienie { NOWY, BYL, PELNY };
+
+    // Miejsce na co najwyżej `maksStanow` stanów; tablica rośnie do dwukrotności tej liczby.
+    explicit ZbiorStanow(uint64_t maksStanow) : limit(maksStanow) {
+        while (pojemnoscMaks < 2 * maksStanow) pojemnoscMaks *= 2;
+        przydziel(std::min<uint64_t>(pojemnoscMaks, POJEMNOSC_POCZATKOWA));
+    }
+
+    ~ZbiorStanow() {
+        std::free(klucze);
+        std::free(rodzice);
+    }
+
+    ZbiorStanow(const ZbiorStanow&) = delete;
+    ZbiorStanow& operator=(const ZbiorStanow&) = delete;
+
+    bool gotowy() const { return klucze && rodzice; }
+    uint64_t maksimum() const { return limit; }
+    uint64_t pojemnosc() const { return maska + 1; }
+    uint64_t bajtow() const { return pojemnosc() * 2 * sizeof(uint64_t); }
+
+    /*
+     * Stan `UINT64_MAX` jest zarezerwowany (klucz + 1 to zero, czyli puste miejsce).
+     * PELNY, gdy w PROB_MAKS kolejnych miejscach nie ma ani stanu, ani wolnego miejsca -
+     * przy zapełnieniu do połowy zdarza się to rzadko, a wtedy i tak trzeba powiększyć.
+     */
+    Wstawienie wstaw(uint64_t stan, uint64_t rodzic) {
+        uint64_t klucz = stan + 1;
+        uint64_t i = mieszaj(stan) & maska;
+        for (uint64_t proba = 0; proba < PROB_MAKS; ++proba, i = (i + 1) & maska) {
+            uint64_t obecny = klucze[i].load(std::memory_order_relaxed);
+            if (obecny == klucz) return Wstawienie::BYL;
+            if (obecny != 0) continue;
+            if (klucze[i].compare_exchange_strong(obecny, klucz, std::memory_order_relaxed)) {
+                // Rodzica czytamy dopiero po przeszukaniu (po join wątków), więc wystarczy zwykły zapis.
+                rodzice[i] = rodzic;
+                return Wstawienie::NOWY;
+            }
+            if (obecny == klucz) return Wstawienie::BYL;
+        }
+        return Wstawienie::PELNY;
+    }
+
+    // Rodzic odwiedzonego stanu (stan początkowy jest swoim własnym rodzicem).
+    uint64_t rodzic(uint64_t stan) const {
+        uint64_t klucz = stan + 1;
+        for (uint64_t i = mieszaj(stan) & maska;; i = (i + 1) & maska) {
+            if (klucze[i].load(std::memory_order_relaxed) == klucz) return rodzice[i];
+        }
+    }
+
+    /*
+     * Dwa razy większa tablica, stany przepisane na nowe miejsca. Tylko wtedy, gdy nikt
+     * nie wstawia (przeszukiwanie robi to na barierze). False, gdy przekroczyłoby to limit
+     * albo zabrakło pamięci - stara tablica zostaje wtedy bez zmian.
+     */
+    bool powieksz() {
+        if (pojemnosc() * 2 > pojemnoscMaks) return false;
+        std::atomic<uint64_t>* stareKlucze = klucze;
+        uint64_t* starzyRodzice = rodzice;
+        uint64_t staraPojemnosc = pojemnosc();
+        if (!przydziel(staraPojemnosc * 2)) {
+            std::free(klucze);
+            std::free(rodzice);
+            klucze = stareKlucze;
+            rodzice = starzyRodzice;
+            maska = staraPojemnosc - 1;
+            return false;
+        }
+        for (uint64_t j = 0; j < staraPojemnosc; ++j) {
+            uint64_t klucz = stareKlucze[j].load(std::memory_order_relaxed);
+            if (klucz == 0) continue;
+            uint64_t i = mieszaj(klucz - 1) & maska;
+            while (klucze[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & maska;
+            klucze[i].store(klucz, std::memory_order_relaxed);
+            rodzice[i] = starzyRodzice[j];
+        }
+        std::free(stareKlucze);
+        std::free(starzyRodzice);
+        return true;
+    }
+
+private:
+    static constexpr uint64_t POJEMNOSC_POCZATKOWA = 1 << 16;
+    static constexpr uint64_t PROB_MAKS = 256;
+
+    // calloc daje wyzerowane tablice - zero to puste miejsce.
+    bool przydziel(uint64_t pojemnosc) {
+        maska = pojemnosc - 1;
+        klucze = static_cast<std::atomic<uint64_t>*>(std::calloc(pojemnosc, sizeof(std::atomic<uint64_t>)));
+        rodzice = static_cast<uint64_t*>(std::calloc(pojemnosc, sizeof(uint64_t)));
+        return gotowy();
+    }
+
+    // Finalizator splitmix64 - sąsiednie stany (różniące się jedną cyfrą) lądują daleko od siebie.
+    static uint64_t mieszaj(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::atomic<uint64_t>* klucze = nullptr;
+    uint64_t* rodzice = nullptr;
+    uint64_t maska = 0;
+    uint64_t limit = 0;
+    uint64_t pojemnoscMaks = 1024;
+};
+
+
+struct WynikPrzeszukania {
+    uint64_t stanow = 0;
+    uint64_t przejsc = 0;
+    int glebokosc = 0;             // Liczba przejrzanych poziomów BFS
+    bool znalezionoBlad = false;
+    uint64_t stanBledu = 0;
+    bool przepelnienie = false;    // Zabrakło miejsca w zbiorze - wynik niepełny
+    double czasS = 0;
+};
+
+template <typename Model>
+WynikPrzeszukania przeszukajWszerz(const Model& model, ZbiorStanow& zbior, int watkow) {
+    // Ile stanów poziomu wątek bierze naraz - rzadziej dotyka wspólnego licznika.
+    const size_t KAWALEK = 256;
+    WynikPrzeszukania wynik;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> poziom = { model.poczatkowy() };
+    zbior.wstaw(poziom[0], poziom[0]);
+    wynik.stanow = 1;
+
+    std::atomic<size_t> nastepny{0};
+    std::atomic<bool> blad{false};
+    std::atomic<bool> pelny{false};
+    std::atomic<uint64_t> stanBledu{0};
+    std::atomic<uint64_t> przejsc{0};
+    bool koniec = false;
+    std::vector<std::vector<uint64_t>> nowe(watkow);
+    // Pary (stan, rodzic), które nie zmieściły się w zbiorze w trakcie poziomu.
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> odlozone(watkow);
+    std::barrier bariera(watkow);
+
+    auto pracuj = [&](int numer) {
+        std::vector<uint64_t> nastepniki;
+        while (true) {
+            uint64_t mojePrzejscia = 0;
+            size_t od;
+            while ((od = nastepny.fetch_add(KAWALEK, std::memory_order_relaxed)) < poziom.size()) {
+                size_t doIndeksu = std::min(poziom.size(), od + KAWALEK);
+                for (size_t i = od; i < doIndeksu; ++i) {
+                    uint64_t stan = poziom[i];
+                    nastepniki.clear();
+                    model.nastepniki(stan, nastepniki);
+                    mojePrzejscia += nastepniki.size();
+                    if (nastepniki.empty() && !model.koncowyPoprawny(stan) && !blad.exchange(true)) {
+                        stanBledu.store(stan);
+                    }
+                    for (uint64_t s : nastepniki) {
+                        ZbiorStanow::Wstawienie w = zbior.wstaw(s, stan);
+                        if (w == ZbiorStanow::Wstawienie::NOWY) nowe[numer].push_back(s);
+                        else if (w == ZbiorStanow::Wstawienie::PELNY) odlozone[numer].push_back({ s, stan });
+                    }
+                }
+            }
+            przejsc.fetch_add(mojePrzejscia, std::memory_order_relaxed);
+            bariera.arrive_and_wait();
+            if (numer == 0) {
+                // Składanie następnego poziomu - reszta wątków czeka na drugiej barierze.
+                poziom.clear();
+                for (std::vector<uint64_t>& lista : nowe) {
+                    poziom.insert(poziom.end(), lista.begin(), lista.end());
+                    lista.clear();
+                }
+                wynik.stanow += poziom.size();
+                std::vector<std::pair<uint64_t, uint64_t>> doWstawienia;
+                for (auto& lista : odlozone) {
+                    doWstawienia.insert(doWstawienia.end(), lista.begin(), lista.end());
+                    lista.clear();
+                }
+                while (2 * wynik.stanow > zbior.pojemnosc() || !doWstawienia.empty()) {
+                    if (!zbior.powieksz()) {
+                        pelny.store(true);
+                        break;
+                    }
+                    std::vector<std::pair<uint64_t, uint64_t>> dalej;
+                    for (auto [s, rodzic] : doWstawienia) {
+                        ZbiorStanow::Wstawienie w = zbior.wstaw(s, rodzic);
+                        if (w == ZbiorStanow::Wstawienie::NOWY) {
+                            poziom.push_back(s);
+                            wynik.stanow++;
+                        } else if (w == ZbiorStanow::Wstawienie::PELNY) {
+                            dalej.push_back({ s, rodzic });
+                        }
+                    }
+                    doWstawienia.swap(dalej);
+                }
+                wynik.glebokosc++;
+                nastepny.store(0, std::memory_order_relaxed);
+                if (wynik.stanow > zbior.maksimum()) pelny.store(true);
+                // Błąd z tego poziomu ma najkrótszą ścieżkę - dalej nie szukamy.
+                koniec = poziom.empty() || blad.load() || pelny.load();
+            }
+            bariera.arrive_and_wait();
+            if (koniec) return;
+        }
+    };
+
+    std::vector<std::thread> pomocnicy;
+    for (int i = 1; i < watkow; ++i) pomocnicy.emplace_back(pracuj, i);
+    pracuj(0);
+    for (std::thread& t : pomocnicy) t.join();
+
+    wynik.przejsc = przejsc.load();
+    wynik.znalezionoBlad = blad.load();
+    wynik.stanBledu = stanBledu.load();
+    wynik.przepelnienie = pelny.load() && !wynik.znalezionoBlad;
+    wynik.czasS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return wynik;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+/*
+ * Rozmieszczenie wątków filozofów na procesorach (przypinanie, affinity).
+ *
+ * Topologię czytamy z sysfs (/sys/devices/system/cpu): dla każdego procesora
+ * logicznego gniazdo (topology/physical_package_id) i domeny pamięci podręcznej
+ * L2 i L3 (cache/indexN/shared_cpu_list) - domenę oznaczamy najmniejszym numerem
+ * procesora, który ją dzieli. Czego w sysfs nie ma, traktujemy jak osobną domenę L2
+ * i wspólną L3 / gniazdo, więc bez sysfs wszystkie tryby nadal działają.
+ *
+ *  - ZWARTE      - procesory posortowane po (gniazdo, L3, L2, numer), kolejne miejsca
+ *                  przy stole dostają kolejne procesory (blokami, gdy miejsc jest więcej) -
+ *                  sąsiedzi dzielą L2/L3 i pałeczka nie przechodzi między gniazdami,
+ *  - ROTACJA     - miejsce i na i-ty procesor (mod liczba procesorów) w kolejności numerów,
+ *                  bez patrzenia na topologię,
+ *  - ROZPROSZONE - celowo najgorszy przypadek: kolejne miejsca na przemian w różnych
+ *                  gniazdach, potem domenach L3 i L2, więc każde przekazanie pałeczki
+ *                  sąsiadowi przechodzi między nimi.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+
+enum class Przypiecie { BRAK, ZWARTE, ROTACJA, ROZPROSZONE };
+
+struct ProcesorLogiczny {
+    int numer;
+    int gniazdo;
+    int domenaL3;
+    int domenaL2;
+};
+
+
+class TopologiaProcesorow {
+public:
+    // Procesory, na których proces może działać (sched_getaffinity); pusta lista przy błędzie.
+    static std::vector<int> dozwoloneProcesory() {
+        std::vector<int> wynik;
+        cpu_set_t zbior;
+        CPU_ZERO(&zbior);
+        if (sched_getaffinity(0, sizeof(zbior), &zbior) != 0) return wynik;
+        for (int i = 0; i < CPU_SETSIZE; ++i) {
+            if (CPU_ISSET(i, &zbior)) wynik.push_back(i);
+        }
+        return wynik;
+    }
+
+    // Lista procesorów w formacie jądra: "0-3,8,10-11".
+    static std::vector<int> parsujListe(const std::string& tekst) {
+        std::vector<int> wynik;
+        size_t i = 0;
+        while (i < tekst.size()) {
+            size_t koniec = tekst.find(',', i);
+            if (koniec == std::string::npos) koniec = tekst.size();
+            std::string zakres = tekst.substr(i, koniec - i);
+            size_t myslnik = zakres.find('-');
+            try {
+                int od = std::stoi(zakres.substr(0, myslnik));
+                int doNumeru = myslnik == std::string::npos ? od : std::stoi(zakres.substr(myslnik + 1));
+                for (int p = od; p <= doNumeru; ++p) wynik.push_back(p);
+            } catch (...) {
+                // Pusty albo uszkodzony kawałek - pomijamy.
+            }
+            i = koniec + 1;
+        }
+        return wynik;
+    }
+
+    // Wczytuje opis procesorów z listy `dozwolone` z katalogu sysfs `katalog`.
+    void wczytaj(const std::vector<int>& dozwolone, const std::string& katalog = "/sys/devices/system/cpu") {
+        procesory.clear();
+        for (int numer : dozwolone) {
+            std::string baza = katalog + "/cpu" + std::to_string(numer);
+            ProcesorLogiczny procesor{ numer, 0, -1, numer };
+            int gniazdo = czytajLiczbe(baza + "/topology/physical_package_id");
+            if (gniazdo >= 0) procesor.gniazdo = gniazdo;
+            for (int indeks = 0;; ++indeks) {
+                std::string pamiec = baza + "/cache/index" + std::to_string(indeks);
+                int poziom = czytajLiczbe(pamiec + "/level");
+                if (poziom < 0) break;
+                std::vector<int> dzielacy = parsujListe(czytajWiersz(pamiec + "/shared_cpu_list"));
+                if (dzielacy.empty()) continue;
+                int domena = *std::min_element(dzielacy.begin(), dzielacy.end());
+                if (poziom == 2) procesor.domenaL2 = domena;
+                else if (poziom == 3) procesor.domenaL3 = domena;
+            }
+            // Bez L3 w sysfs: wspólna domena całego gniazda.
+            if (procesor.domenaL3 < 0) procesor.domenaL3 = -1 - procesor.gniazdo;
+            procesory.push_back(procesor);
+        }
+    }
+
+    int liczbaProcesorow() const { return (int)procesory.size(); }
+    int liczbaGniazd() const { return liczbaRoznych(&ProcesorLogiczny::gniazdo); }
+    int liczbaDomenL3() const { return liczbaRoznych(&ProcesorLogiczny::domenaL3); }
+    int liczbaDomenL2() const { return liczbaRoznych(&ProcesorLogiczny::domenaL2); }
+
+    // Opis procesora o numerze systemowym `numer` (nullptr, gdy go nie wczytano).
+    const ProcesorLogiczny* znajdz(int numer) const {
+        for (const ProcesorLogiczny& procesor : procesory) {
+            if (procesor.numer == numer) return &procesor;
+        }
+        return nullptr;
+    }
+
+    // Numer procesora dla każdego z `miejsc` miejsc przy stole (pusto dla BRAK albo bez procesorów).
+    std::vector<int> rozmiesc(Przypiecie tryb, int miejsc) const {
+        std::vector<int> wynik;
+        int m = liczbaProcesorow();
+        if (tryb == Przypiecie::BRAK || m == 0) return wynik;
+        std::vector<int> kolejnosc(m);
+        for (int i = 0; i < m; ++i) kolejnosc[i] = i;
+        if (tryb != Przypiecie::ROTACJA) {
+            std::sort(kolejnosc.begin(), kolejnosc.end(), [&](int a, int b) {
+                const ProcesorLogiczny& x = procesory[a];
+                const ProcesorLogiczny& y = procesory[b];
+                if (x.gniazdo != y.gniazdo) return x.gniazdo < y.gniazdo;
+                if (x.domenaL3 != y.domenaL3) return x.domenaL3 < y.domenaL3;
+                if (x.domenaL2 != y.domenaL2) return x.domenaL2 < y.domenaL2;
+                return x.numer < y.numer;
+            });
+        }
+        if (tryb == Przypiecie::ROZPROSZONE) kolejnosc = rozprosz(kolejnosc, 0);
+        wynik.resize(miejsc);
+        for (int i = 0; i < miejsc; ++i) {
+            // Zwarte: więcej miejsc niż procesorów - sąsiednie miejsca blokami na tym samym procesorze.
+            int j = tryb == Przypiecie::ZWARTE && miejsc > m ? (int)((long long)i * m / miejsc) : i % m;
+            wynik[i] = procesory[kolejnosc[j]].numer;
+        }
+        return wynik;
+    }
+
+    // Przypina bieżący wątek do procesora `numer`.
+    static bool przypnijWatek(int numer) {
+        cpu_set_t zbior;
+        CPU_ZERO(&zbior);
+        CPU_SET(numer, &zbior);
+        return pthread_setaffinity_np(pthread_self(), sizeof(zbior), &zbior) == 0;
+    }
+
+private:
+    static std::string czytajWiersz(const std::string& sciezka) {
+        std::ifstream plik(sciezka);
+        std::string wiersz;
+        std::getline(plik, wiersz);
+        return wiersz;
+    }
+
+    static int czytajLiczbe(const std::string& sciezka) {
+        std::ifstream plik(sciezka);
+        int wartosc = -1;
+        if (!(plik >> wartosc)) return -1;
+        return wartosc;
+    }
+
+    int liczbaRoznych(int ProcesorLogiczny::*pole) const {
+        std::vector<int> wartosci;
+        for (const ProcesorLogiczny& procesor : procesory) wartosci.push_back(procesor.*pole);
+        std::sort(wartosci.begin(), wartosci.end());
+        return (int)(std::unique(wartosci.begin(), wartosci.end()) - wartosci.begin());
+    }
+
+    /*
+     * Kolejność "jak najdalej": dzieli procesory (w kolejności zwartej) na grupy wg
+     * poziomu (0 - gniazdo, 1 - L3, 2 - L2), każdą grupę porządkuje tak samo poziom
+     * niżej i bierze na zmianę po jednym procesorze z każdej grupy.
+     */
+    std::vector<int> rozprosz(const std::vector<int>& indeksy, int poziom) const {
+        if (poziom == 3 || indeksy.size() <= 1) return indeksy;
+        int ProcesorLogiczny::*pole = poziom == 0 ? &ProcesorLogiczny::gniazdo
+                                    : poziom == 1 ? &ProcesorLogiczny::domenaL3 : &ProcesorLogiczny::domenaL2;
+        std::vector<int> klucze;
+        std::vector<std::vector<int>> grupy;
+        for (int i : indeksy) {
+            int klucz = procesory[i].*pole;
+            size_t g = std::find(klucze.begin(), klucze.end(), klucz) - klucze.begin();
+            if (g == klucze.size()) {
+                klucze.push_back(klucz);
+                grupy.emplace_back();
+            }
+            grupy[g].push_back(i);
+        }
+        for (std::vector<int>& grupa : grupy) grupa = rozprosz(grupa, poziom + 1);
+        std::vector<int> wynik;
+        for (size_t k = 0; wynik.size() < indeksy.size(); ++k) {
+            for (const std::vector<int>& grupa : grupy) {
+                if (k < grupa.size()) wynik.push_back(grupa[k]);
+            }
+        }
+        return wynik;
+    }
+
+    std::vector<ProcesorLogiczny> procesory;
+};
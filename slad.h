@@ -0,0 +1,167 @@
+#pragma once
+
+/*
+ * Ślad zdarzeń (tracing) o małym narzucie.
+ *
+ * Każdy wątek pisze do własnego bufora cyklicznego stałego rozmiaru - bez blokad
+ * i bez operacji read-modify-write: zapis zdarzenia to odczyt zegara, skopiowanie
+ * 16 bajtów i przesunięcie licznika. Gdy bufor się zapełni, najstarsze zdarzenia
+ * są nadpisywane (zostaje koniec przebiegu). Bufory zbieramy dopiero na końcu.
+ *
+ * Czas to takty TSC (x86) przeliczane na nanosekundy przy zbieraniu albo
+ * nanosekundy z zegara podanego przez ustawZegar() (np. czasu wirtualnego).
+ * Ślad jest jeden na program - bufor wątku trzymamy w zmiennej thread_local.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+struct ZdarzenieSladu {
+    uint64_t czas;           // Takty albo ns (po zbierz() zawsze ns od włączenia śladu)
+    int32_t kto;             // Kto (filozof)
+    uint32_t argument : 28;  // Np. numer pałeczki albo nowy stan
+    uint32_t rodzaj : 4;
+};
+static_assert(sizeof(ZdarzenieSladu) == 16, "zdarzenie ma zajmowac 16 bajtow");
+
+
+// Bufor cykliczny jednego wątku: jeden pisarz, czytanie dopiero przy zbieraniu.
+class BuforSladu {
+public:
+    explicit BuforSladu(size_t minimalnaPojemnosc) {
+        size_t pojemnosc = 1;
+        while (pojemnosc < minimalnaPojemnosc) pojemnosc *= 2;
+        maska = pojemnosc - 1;
+        zdarzenia.reset(new ZdarzenieSladu[pojemnosc]);
+    }
+
+    void zapisz(const ZdarzenieSladu& zdarzenie) {
+        uint64_t i = zapisane.load(std::memory_order_relaxed);
+        zdarzenia[i & maska] = zdarzenie;
+        zapisane.store(i + 1, std::memory_order_release);
+    }
+
+    // Dokleja zachowane zdarzenia (bez nadpisanych) i zwraca, ile nadpisano.
+    uint64_t kopiuj(std::vector<ZdarzenieSladu>& wynik) const {
+        uint64_t koniec = zapisane.load(std::memory_order_acquire);
+        uint64_t pojemnosc = maska + 1;
+        uint64_t poczatek = koniec > pojemnosc ? koniec - pojemnosc : 0;
+        for (uint64_t i = poczatek; i < koniec; ++i) wynik.push_back(zdarzenia[i & maska]);
+        return poczatek;
+    }
+
+private:
+    std::unique_ptr<ZdarzenieSladu[]> zdarzenia;
+    uint64_t maska = 0;
+    std::atomic<uint64_t> zapisane{0};
+};
+
+
+class Slad {
+public:
+    // Włącza zapisywanie; każdy wątek dostanie bufor na `pojemnoscNaWatek` zdarzeń.
+    void wlacz(size_t pojemnoscNaWatek) {
+        pojemnosc = pojemnoscNaWatek;
+        taktyStartu = takty();
+        nsStartu = nsZegara();
+        nsStartuZegara = nsStartu;
+        aktywny = true;
+    }
+
+    bool wlaczony() const { return aktywny; }
+
+    // Zegar w ns zamiast TSC (np. czas wirtualny korutyn). Ustawiać przed pierwszym zdarzeniem.
+    void ustawZegar(uint64_t (*zegarNs)()) {
+        zegar = zegarNs;
+        nsStartu = zegar();
+    }
+
+    void zapisz(unsigned rodzaj, int kto, unsigned argument) {
+        BuforSladu* bufor = buforWatku;
+        if (!bufor) bufor = zarejestruj();
+        ZdarzenieSladu zdarzenie;
+        zdarzenie.czas = zegar ? zegar() : takty();
+        zdarzenie.kto = kto;
+        zdarzenie.argument = argument;
+        zdarzenie.rodzaj = rodzaj;
+        bufor->zapisz(zdarzenie);
+    }
+
+    // Bieżąca chwila w ns od włączenia śladu - do zamknięcia przedziałów otwartych na końcu.
+    uint64_t nsOdStartu() const {
+        if (zegar) return zegar() - nsStartu;
+        return nsZegara() - nsStartuZegara;
+    }
+
+    /*
+     * Zbiera zdarzenia ze wszystkich buforów, przelicza czas na ns od włączenia śladu
+     * i sortuje po czasie (w obrębie wątku kolejność zapisu zostaje).
+     */
+    std::vector<ZdarzenieSladu> zbierz(uint64_t& utracone) {
+        std::vector<ZdarzenieSladu> wynik;
+        utracone = 0;
+        {
+            std::lock_guard<std::mutex> blokada(rejestrBlokada);
+            for (const auto& bufor : bufory) utracone += bufor->kopiuj(wynik);
+        }
+        // Kalibracja TSC: takty i ns ze startu oraz z teraz.
+        double nsNaTakt = 1.0;
+        uint64_t taktyTeraz = takty();
+        uint64_t nsTeraz = nsZegara();
+        if (!zegar && taktyTeraz > taktyStartu) {
+            nsNaTakt = (double)(nsTeraz - nsStartuZegara) / (double)(taktyTeraz - taktyStartu);
+        }
+        for (ZdarzenieSladu& zdarzenie : wynik) {
+            if (zegar) {
+                zdarzenie.czas = zdarzenie.czas > nsStartu ? zdarzenie.czas - nsStartu : 0;
+            } else {
+                zdarzenie.czas = zdarzenie.czas > taktyStartu
+                    ? (uint64_t)((zdarzenie.czas - taktyStartu) * nsNaTakt) : 0;
+            }
+        }
+        std::stable_sort(wynik.begin(), wynik.end(),
+                         [](const ZdarzenieSladu& a, const ZdarzenieSladu& b) { return a.czas < b.czas; });
+        return wynik;
+    }
+
+private:
+    static uint64_t takty() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return nsZegara();
+#endif
+    }
+
+    static uint64_t nsZegara() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    BuforSladu* zarejestruj() {
+        std::lock_guard<std::mutex> blokada(rejestrBlokada);
+        bufory.emplace_back(new BuforSladu(pojemnosc));
+        buforWatku = bufory.back().get();
+        return buforWatku;
+    }
+
+    static inline thread_local BuforSladu* buforWatku = nullptr;
+
+    bool aktywny = false;
+    size_t pojemnosc = 0;
+    uint64_t (*zegar)() = nullptr;
+    uint64_t taktyStartu = 0;
+    uint64_t nsStartu = 0;        // Start na zegarze śladu (steady_clock albo ustawZegar)
+    uint64_t nsStartuZegara = 0;  // Start na steady_clock - do kalibracji TSC
+    std::mutex rejestrBlokada;
+    std::vector<std::unique_ptr<BuforSladu>> bufory;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+/*
+ * Topologia stołu: który filozof (agent) potrzebuje których pałeczek (zasobów).
+ *
+ * Klasyczny stół to pierścień - filozof i bierze pałeczki i oraz i+1. Tu agent może
+ * potrzebować dowolnych k zasobów naraz, a zasób może być dzielony przez wielu agentów
+ * (model wielozasobowych transakcji). Listy trzymamy w formacie CSR: jedna tablica
+ * numerów zasobów wszystkich agentów po kolei i tablica początków - lista agenta to
+ * ciągły kawałek pamięci, bez wskaźników i osobnych alokacji (100k zasobów to ~1 MB).
+ * Odwrotne CSR (zasób -> agenci, którzy go używają) daje sąsiadów agenta.
+ *
+ * Kolejność na liście agenta jest "deklarowana" (np. prawa, dół, lewa, góra w siatce) -
+ * naiwna strategia bierze zasoby właśnie w tej kolejności i może się zakleszczyć;
+ * hierarchia sortuje listę.
+ *
+ *  - pierscien(n)          - n agentów, n zasobów, agent i: [i, i+1 mod n],
+ *  - siatka(W, H, torus)   - agent w każdym węźle siatki W x H, zasób na każdej krawędzi
+ *                            (z zawijaniem - torus, każdy agent ma 4 zasoby),
+ *  - losowa(n, R, k)       - każdy agent losuje k różnych zasobów spośród R,
+ *  - zPliku(sciezka)       - niepusty wiersz pliku = lista zasobów agenta (numery od 0,
+ *                            '#' zaczyna komentarz).
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+class Topologia {
+public:
+    Topologia() : poczatki(1, 0), poczatkiOdwrotne(1, 0) {}
+
+    static Topologia pierscien(int n) {
+        Topologia t("pierscien");
+        for (int i = 0; i < n; ++i) t.dodajAgenta({ i, (i + 1) % n });
+        t.zakoncz(n);
+        return t;
+    }
+
+    /*
+     * Krawędzie poziome mają numery 0.., potem pionowe. Deklarowana kolejność agenta:
+     * prawa, dół, lewa, góra (brzegowe krawędzie siatki bez zawijania pomijamy).
+     */
+    static Topologia siatka(int szerokosc, int wysokosc, bool torus) {
+        Topologia t(std::string(torus ? "torus:" : "siatka:") + std::to_string(szerokosc) + "x"
+                    + std::to_string(wysokosc));
+        int w = szerokosc, h = wysokosc;
+        int poziomychWWierszu = torus ? w : w - 1;
+        int pionowychWierszy = torus ? h : h - 1;
+        int poziomych = poziomychWWierszu * h;
+        // Krawędź od (x, y) w prawo / w dół; -1, gdy wychodzi poza siatkę bez zawijania.
+        auto wPrawo = [&](int x, int y) { return x < poziomychWWierszu ? y * poziomychWWierszu + x : -1; };
+        auto wDol = [&](int x, int y) { return y < pionowychWierszy ? poziomych + y * w + x : -1; };
+        std::vector<int> zasoby;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                zasoby.clear();
+                int lewy = x > 0 ? x - 1 : (torus ? w - 1 : -1);
+                int gorny = y > 0 ? y - 1 : (torus ? h - 1 : -1);
+                for (int z : { wPrawo(x, y), wDol(x, y), lewy >= 0 ? wPrawo(lewy, y) : -1,
+                               gorny >= 0 ? wDol(x, gorny) : -1 }) {
+                    if (z >= 0) zasoby.push_back(z);
+                }
+                t.dodajAgenta(zasoby);
+            }
+        }
+        t.zakoncz(poziomych + pionowychWierszy * w);
+        return t;
+    }
+
+    static Topologia losowa(int agentow, int zasobow, int k, uint64_t ziarno) {
+        Topologia t("losowa:" + std::to_string(zasobow) + ":" + std::to_string(k));
+        std::mt19937_64 generator(ziarno);
+        std::uniform_int_distribution<int> dystrybucja(0, zasobow - 1);
+        std::vector<int> zasoby;
+        for (int i = 0; i < agentow; ++i) {
+            zasoby.clear();
+            // k jest małe - losowanie z odrzucaniem powtórzeń.
+            while ((int)zasoby.size() < k) {
+                int z = dystrybucja(generator);
+                if (std::find(zasoby.begin(), zasoby.end(), z) == zasoby.end()) zasoby.push_back(z);
+            }
+            t.dodajAgenta(zasoby);
+        }
+        t.zakoncz(zasobow);
+        return t;
+    }
+
+    // Zwraca false (i opis w `blad`), gdy pliku nie ma albo jest niepoprawny.
+    static bool zPliku(const std::string& sciezka, Topologia& wynik, std::string& blad) {
+        std::ifstream plik(sciezka);
+        if (!plik) {
+            blad = "nie udalo sie otworzyc " + sciezka;
+            return false;
+        }
+        Topologia t("plik:" + sciezka);
+        std::string wiersz;
+        std::vector<int> zasoby;
+        int zasobow = 0;
+        for (int numer = 1; std::getline(plik, wiersz); ++numer) {
+            wiersz = wiersz.substr(0, wiersz.find('#'));
+            std::istringstream strumien(wiersz);
+            zasoby.clear();
+            long long z;
+            while (strumien >> z) {
+                if (z < 0 || z >= (1 << 28)) {
+                    blad = "wiersz " + std::to_string(numer) + ": zly numer zasobu";
+                    return false;
+                }
+                if (std::find(zasoby.begin(), zasoby.end(), (int)z) != zasoby.end()) {
+                    blad = "wiersz " + std::to_string(numer) + ": zasob " + std::to_string(z) + " powtorzony";
+                    return false;
+                }
+                zasoby.push_back((int)z);
+                zasobow = std::max(zasobow, (int)z + 1);
+            }
+            if (!strumien.eof()) {
+                blad = "wiersz " + std::to_string(numer) + ": oczekiwano numerow zasobow";
+                return false;
+            }
+            if (!zasoby.empty()) t.dodajAgenta(zasoby);
+        }
+        if (t.liczbaAgentow() < 2) {
+            blad = "potrzeba co najmniej dwoch agentow";
+            return false;
+        }
+        t.zakoncz(zasobow);
+        wynik = std::move(t);
+        return true;
+    }
+
+    int liczbaAgentow() const { return (int)poczatki.size() - 1; }
+    int liczbaZasobow() const { return (int)poczatkiOdwrotne.size() - 1; }
+    int maksZasobowAgenta() const { return maksNaAgenta; }
+    const std::string& nazwa() const { return opis; }
+    // Pierścień - strategie pisane pod klasyczny stół (asymetria, kelner, Chandy-Misra) działają tylko na nim.
+    bool jestPierscieniem() const { return opis == "pierscien"; }
+
+    // Zasoby agenta w kolejności deklarowanej.
+    std::span<const int> zasoby(int agent) const {
+        return { zasobyAgentow.data() + poczatki[agent], (size_t)(poczatki[agent + 1] - poczatki[agent]) };
+    }
+
+    // Agenci, którzy używają zasobu (rosnąco).
+    std::span<const int> uzytkownicy(int zasob) const {
+        return { agenciZasobow.data() + poczatkiOdwrotne[zasob],
+                 (size_t)(poczatkiOdwrotne[zasob + 1] - poczatkiOdwrotne[zasob]) };
+    }
+
+    // Początek listy agenta w tablicy CSR - ten sam układ mają kolejności pobierania.
+    int poczatek(int agent) const { return poczatki[agent]; }
+    int rozmiarCsr() const { return (int)zasobyAgentow.size(); }
+
+private:
+    explicit Topologia(std::string nazwa) : opis(std::move(nazwa)), poczatki(1, 0) {}
+
+    void dodajAgenta(const std::vector<int>& zasoby) {
+        zasobyAgentow.insert(zasobyAgentow.end(), zasoby.begin(), zasoby.end());
+        poczatki.push_back((int)zasobyAgentow.size());
+        maksNaAgenta = std::max(maksNaAgenta, (int)zasoby.size());
+    }
+
+    // Buduje odwrotne CSR (sortowanie kubełkowe po numerze zasobu).
+    void zakoncz(int zasobow) {
+        poczatkiOdwrotne.assign(zasobow + 1, 0);
+        for (int z : zasobyAgentow) poczatkiOdwrotne[z + 1]++;
+        for (int z = 0; z < zasobow; ++z) poczatkiOdwrotne[z + 1] += poczatkiOdwrotne[z];
+        agenciZasobow.resize(zasobyAgentow.size());
+        std::vector<int> wolne(poczatkiOdwrotne.begin(), poczatkiOdwrotne.end() - 1);
+        for (int a = 0; a < liczbaAgentow(); ++a) {
+            for (int i = poczatki[a]; i < poczatki[a + 1]; ++i) agenciZasobow[wolne[zasobyAgentow[i]]++] = a;
+        }
+    }
+
+    std::string opis;
+    std::vector<int> poczatki;         // liczbaAgentow + 1
+    std::vector<int> zasobyAgentow;
+    std::vector<int> poczatkiOdwrotne; // liczbaZasobow + 1
+    std::vector<int> agenciZasobow;
+    int maksNaAgenta = 0;
+};